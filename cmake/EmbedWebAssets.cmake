@@ -0,0 +1,66 @@
+# Erzeugt eine C-Datei mit den Frontend-Dateien als konstante Byte-Tabellen.
+# Aufruf: cmake -DWEB_DIR=<web> -DOUTPUT=<datei.c> -P EmbedWebAssets.cmake
+
+file(GLOB ASSET_FILES RELATIVE "${WEB_DIR}" "${WEB_DIR}/*")
+list(SORT ASSET_FILES)
+
+set(CONTENT "/* Automatisch erzeugt aus ${WEB_DIR} - nicht bearbeiten */\n")
+string(APPEND CONTENT "#include \"webserver/web_assets.h\"\n\n")
+set(TABLE "")
+# Muster für 16 Bytes pro Zeile (CMake-Regex kennt keine {n}-Quantoren)
+set(LINE_PATTERN "")
+foreach (I RANGE 15)
+    string(APPEND LINE_PATTERN "0x[0-9a-f][0-9a-f],")
+endforeach()
+set(INDEX 0)
+
+foreach (NAME IN LISTS ASSET_FILES)
+    set(FILE_PATH "${WEB_DIR}/${NAME}")
+    if (IS_DIRECTORY "${FILE_PATH}")
+        continue()
+    endif()
+
+    string(REGEX MATCH "\\.[^.]*$" EXT "${NAME}")
+    string(TOLOWER "${EXT}" EXT)
+    if (EXT STREQUAL ".html")
+        set(TYPE "text/html; charset=utf-8")
+    elseif (EXT STREQUAL ".css")
+        set(TYPE "text/css; charset=utf-8")
+    elseif (EXT STREQUAL ".js")
+        set(TYPE "application/javascript; charset=utf-8")
+    elseif (EXT STREQUAL ".json")
+        set(TYPE "application/json; charset=utf-8")
+    elseif (EXT STREQUAL ".png")
+        set(TYPE "image/png")
+    elseif (EXT STREQUAL ".jpg" OR EXT STREQUAL ".jpeg")
+        set(TYPE "image/jpeg")
+    elseif (EXT STREQUAL ".svg")
+        set(TYPE "image/svg+xml")
+    else()
+        set(TYPE "application/octet-stream")
+    endif()
+
+    file(SHA256 "${FILE_PATH}" HASH)
+    string(SUBSTRING "${HASH}" 0 16 ETAG)
+    file(READ "${FILE_PATH}" HEX HEX)
+    string(LENGTH "${HEX}" SIZE)
+    math(EXPR SIZE "${SIZE} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " BYTES "${BYTES}")
+
+    # Ein zusätzliches Nullbyte hält auch leere Dateien gültig
+    string(APPEND CONTENT "static const unsigned char ASSET_${INDEX}[] = {\n    ${BYTES}0x00\n};\n\n")
+    string(APPEND TABLE "    { \"${NAME}\", ASSET_${INDEX}, ${SIZE}u, \"${TYPE}\", \"\\\"${ETAG}\\\"\" },\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+string(APPEND CONTENT "const EmbeddedAsset WEB_EMBEDDED_ASSETS[] = {\n${TABLE}    { NULL, NULL, 0u, NULL, NULL }\n};\n")
+
+# Nur schreiben, wenn sich etwas geändert hat, damit nicht unnötig neu kompiliert wird
+if (EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" PREVIOUS)
+    if (PREVIOUS STREQUAL CONTENT)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${CONTENT}")
@@ -8,6 +8,37 @@
 #define CONFIG_DEFAULT_LOG_LEVEL 2
 #define CONFIG_DEFAULT_MAX_ARTICLES 500
 #define CONFIG_DEFAULT_MAX_STRING_LENGTH 256
+#define CONFIG_SERVER_MODE_THREADS 0           // Blockierende Sockets, Worker-Pool
+#define CONFIG_SERVER_MODE_EPOLL 1             // Nicht-blockierender epoll-Reaktor (nur Linux)
+#ifndef CONFIG_DEFAULT_SERVER_MODE
+#define CONFIG_DEFAULT_SERVER_MODE CONFIG_SERVER_MODE_THREADS
+#endif
+#ifndef CONFIG_DEFAULT_LISTENER_SHARDS
+#define CONFIG_DEFAULT_LISTENER_SHARDS 1       // epoll-Modus: 0 = ein Listener je CPU-Kern
+#endif
+#define CONFIG_DEFAULT_WORKER_THREADS 0        // 0 = automatisch (2 pro CPU-Kern, mindestens 4)
+#define CONFIG_DEFAULT_CONNECTION_QUEUE_DEPTH 64
+#define CONFIG_DEFAULT_LISTEN_BACKLOG 511
+#define CONFIG_DEFAULT_CONCURRENCY_LIMIT_INITIAL 32
+#define CONFIG_DEFAULT_CONCURRENCY_LIMIT_MIN 4
+#define CONFIG_DEFAULT_CONCURRENCY_LIMIT_MAX 512   // 0 = keine Begrenzung
+#define CONFIG_DEFAULT_KEEPALIVE_TIMEOUT_MS 5000
+#define CONFIG_DEFAULT_KEEPALIVE_MAX_REQUESTS 100
+#define CONFIG_DEFAULT_HEADER_TIMEOUT_MS 10000
+#define CONFIG_DEFAULT_BODY_TIMEOUT_MS 30000
+#define CONFIG_DEFAULT_WRITE_TIMEOUT_MS 60000
+#define CONFIG_DEFAULT_ACCESS_LOG 1
+#ifndef CONFIG_DEFAULT_SLOW_REQUEST_MS
+#define CONFIG_DEFAULT_SLOW_REQUEST_MS 500     // Nur mit -DWEB_TRACE=ON wirksam
+#endif
+#define CONFIG_DEFAULT_STATIC_CACHE_MAX_BYTES (16u * 1024u * 1024u)
+#define CONFIG_DEFAULT_STATIC_CACHE_MAX_FILE_SIZE (1024u * 1024u)
+
+// Log-Level
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
 
 // Globale Konfigurationsstruktur
 typedef struct {
@@ -15,6 +46,23 @@ typedef struct {
     int log_level;             // Log-Level: 0=ERROR, 1=WARN, 2=INFO, 3=DEBUG
     size_t max_articles;       // Maximale Anzahl verwalteter Artikel
     size_t max_string_length;  // Maximale Länge generischer Strings
+    int server_mode;           // CONFIG_SERVER_MODE_THREADS oder CONFIG_SERVER_MODE_EPOLL
+    size_t listener_shards;    // epoll-Modus: Listener-Threads mit eigenem SO_REUSEPORT-Socket
+    size_t worker_threads;     // Anzahl der Worker-Threads (0 = automatisch)
+    size_t connection_queue_depth; // Plätze in der Verbindungswarteschlange
+    int listen_backlog;        // Vom Kernel gehaltene, noch nicht angenommene Verbindungen
+    size_t concurrency_limit_initial; // Startwert des adaptiven Anfragelimits
+    size_t concurrency_limit_min;
+    size_t concurrency_limit_max;     // 0 = keine Begrenzung
+    int keepalive_timeout_ms;  // Leerlaufzeit, nach der persistente Verbindungen geschlossen werden
+    int keepalive_max_requests; // Maximale Anfragen pro Verbindung (1 = kein Keep-Alive)
+    int header_timeout_ms;     // Ab dem ersten Byte bzw. der Annahme bis zum vollständigen Kopf
+    int body_timeout_ms;       // Ab dem vollständigen Kopf bis zum vollständigen Body
+    int write_timeout_ms;      // Längstes Warten auf den Client während eines Sendevorgangs
+    int access_log;            // 1 = jede beantwortete Anfrage auf Level INFO protokollieren
+    int slow_request_ms;       // Ab dieser Dauer wird eine Anfrage mit Phasenzeiten protokolliert (-1 = aus)
+    size_t static_cache_max_bytes;     // Speicher für gecachte statische Dateien (0 = aus)
+    size_t static_cache_max_file_size; // Größere Dateien werden per sendfile gesendet
 } AppConfig;
 
 // Globaler Konfigurationszustand (wird in config.c definiert)
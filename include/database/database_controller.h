@@ -3,11 +3,13 @@
 
 // High-Level-Steuerung für Datenbankoperationen
 #include "database/csv_database_utils.h"
+#include "database/database_storage_utils.h"
 #include "database/quantity_unit_utils.h"
 #include "database/text_input_utils.h"
 
 int load_database(const char *dateipfad, Datenbank *datenbank);
 int save_database(const Datenbank *datenbank);
+void free_database(Datenbank *datenbank);
 int list_csv_files(const char *verzeichnis, char dateien[][DB_MAX_DATEINAME], int max_dateien);
 
 #endif // DATABASE_CONTROLLER_H
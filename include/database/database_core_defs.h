@@ -3,30 +3,53 @@
 
 // Zentrale Strukturen und Konstanten für die Datenbankverwaltung
 #include <stddef.h>
+#include <stdint.h>
 
-#define DB_MAX_EINTRAEGE 512
-#define DB_MAX_TEXTLAENGE 128
+#define DB_MAX_TEXTLAENGE 128          // Obergrenze für Texteingaben über die API
 #define DB_MAX_DATEINAME 260
+#define DB_START_KAPAZITAET 64
+#define DB_TEXTBLOCK_GROESSE 65536
+#define DB_KEIN_TEXT UINT32_MAX
 
 typedef struct {
     int id;
-    char artikel[DB_MAX_TEXTLAENGE];
-    char anbieter[DB_MAX_TEXTLAENGE];
+    uint32_t artikel_id;       // Index im Wörterbuch der Datenbank
+    uint32_t anbieter_id;
     int preis_ct;
     double menge_wert;
     char menge_einheit[8];
 } DatenbankEintrag;
 
+// Block des Textspeichers; Texte bleiben bis datenbank_freigeben gültig
+typedef struct DatenbankTextblock {
+    struct DatenbankTextblock *naechster;
+    size_t belegt;
+    size_t groesse;
+    char daten[];
+} DatenbankTextblock;
+
+// Jeder Text wird pro Datenbank nur einmal gespeichert; Einträge verweisen per Id darauf
+typedef struct {
+    const char **texte;        // Id -> Text im Textspeicher
+    uint32_t anzahl;
+    uint32_t kapazitaet;
+    uint32_t *plaetze;         // Hashtabelle mit offener Adressierung, Id + 1 (0 = frei)
+    uint32_t platz_anzahl;     // Zweierpotenz
+} DatenbankWoerterbuch;
+
+// Einträge wachsen mit den Daten; die Anzahl ist nur durch den Speicher begrenzt
 typedef struct {
-    DatenbankEintrag eintraege[DB_MAX_EINTRAEGE];
+    DatenbankEintrag *eintraege;
     int anzahl;
+    int kapazitaet;
+    DatenbankTextblock *texte;
+    DatenbankWoerterbuch woerterbuch;
     char dateiname[DB_MAX_DATEINAME];
 } Datenbank;
 
 typedef DatenbankEintrag DatabaseEntry;
 typedef Datenbank Database;
 
-#define DB_MAX_ENTRIES DB_MAX_EINTRAEGE
 #define DB_MAX_TEXT DB_MAX_TEXTLAENGE
 #define DB_MAX_FILENAME DB_MAX_DATEINAME
 
@@ -0,0 +1,18 @@
+#ifndef DATABASE_STORAGE_UTILS_H
+#define DATABASE_STORAGE_UTILS_H
+
+// Speicherverwaltung für Datenbanken: wachsende Eintragsliste und Textspeicher
+#include "database/database_core_defs.h"
+
+void datenbank_init(Datenbank *datenbank);
+void datenbank_freigeben(Datenbank *datenbank);
+// Hängt einen leeren Eintrag an und vergrößert die Liste bei Bedarf (NULL ohne Speicher)
+DatenbankEintrag *datenbank_neuer_eintrag(Datenbank *datenbank);
+// Liefert die Id von text und legt ihn bei Bedarf im Wörterbuch an (-1 ohne Speicher)
+int datenbank_text_internieren(Datenbank *datenbank, const char *text, uint32_t *id);
+// Sucht text nur nach; DB_KEIN_TEXT, wenn er nie interniert wurde. Texte, die kein Eintrag
+// mehr verwendet, bleiben bis zum Neuladen im Wörterbuch und werden weiterhin gefunden
+uint32_t datenbank_text_suchen(const Datenbank *datenbank, const char *text);
+const char *datenbank_text(const Datenbank *datenbank, uint32_t id);
+
+#endif // DATABASE_STORAGE_UTILS_H
@@ -0,0 +1,21 @@
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <stddef.h>
+
+// Zahlen ohne printf und unabhängig von der Locale schreiben (immer '.' als Dezimaltrenner).
+// Die Ausgabe ist nullterminiert; zurückgegeben wird die Länge ohne '\0'.
+
+#define NUMBER_FORMAT_MAX 48
+
+// Wie "%lld"; out muss mindestens 21 Zeichen fassen
+size_t format_integer(long long value, char *out);
+// Wie "%.2f" für value / 100, aber ohne Umweg über double
+size_t format_cents(long long cents, char *out);
+// Wie "%.<decimals>f" (0..9 Nachkommastellen); out muss NUMBER_FORMAT_MAX Zeichen fassen.
+// Große Werte und exakte Rundungsgrenzfälle gehen an snprintf, damit das Ergebnis gleich bleibt.
+// Passt das Ergebnis nicht in NUMBER_FORMAT_MAX (sehr große Werte), wird wie "%.17g" geschrieben;
+// die Rückgabe ist daher immer kleiner als NUMBER_FORMAT_MAX.
+size_t format_fixed(double value, int decimals, char *out);
+
+#endif
@@ -5,7 +5,7 @@
 #include "webserver/web_core.h"
 #include "webserver/web_parser.h"
 
-void api_compare_handle_single(socket_t client, const HttpRequest *req);
-void api_compare_handle_list(socket_t client, const HttpRequest *req);
+void api_compare_handle_single(HttpClient *client, const HttpRequest *req);
+void api_compare_handle_list(HttpClient *client, const HttpRequest *req);
 
 #endif
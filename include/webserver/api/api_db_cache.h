@@ -0,0 +1,21 @@
+#ifndef API_DB_CACHE_H
+#define API_DB_CACHE_H
+
+// Prozessweiter Cache geparster Datenbanken, Schlüssel ist der Dateipfad. Vor jeder Nutzung
+// wird per stat() geprüft, ob sich mtime oder Größe geändert haben; nur dann wird neu geladen.
+#include "database/database_core_defs.h"
+#include "webserver/api/api_db_columns.h"
+
+// Liefert die Datenbank zu path (NULL bei Fehler); mit database_cache_release freigeben
+const Database *database_cache_acquire(const char *path);
+void database_cache_release(const Database *db);
+// Spaltenansicht einer per database_cache_acquire gelieferten Datenbank, gültig bis release
+const DatabaseColumns *database_cache_columns(const Database *db);
+// Wie database_cache_acquire, die Einträge dürfen aber direkt geändert werden.
+// Nur mit api_data_lock_write aufrufen, damit kein Leser die Datenbank gleichzeitig nutzt.
+Database *database_cache_acquire_for_update(const char *path);
+// Speichert eine per database_cache_acquire_for_update geänderte Datenbank und übernimmt
+// den neuen Dateistand in den Cache; schlägt das Speichern fehl, wird der Eintrag verworfen
+int database_cache_commit(Database *db);
+
+#endif
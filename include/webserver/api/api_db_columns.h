@@ -0,0 +1,28 @@
+#ifndef API_DB_COLUMNS_H
+#define API_DB_COLUMNS_H
+
+// Spaltenweise Kopie der für Preisvergleiche nötigen Felder einer Datenbank. Scans lesen
+// so nur dicht gepackte Zahlen statt ganzer Einträge; Index i entspricht db->eintraege[i].
+#include "database/database_core_defs.h"
+#include "webserver/api/api_utils.h"
+
+#include <stdint.h>
+
+typedef struct {
+    int *ids;
+    int *price_ct;
+    double *amount;            // In g, ml bzw. Stück; 0, wenn die Menge nicht auswertbar ist
+    unsigned char *unit;       // UnitType
+    uint32_t *article_id;
+    uint32_t *provider_id;
+    int count;
+    void *block;               // Alle Spalten liegen in einer Allokation
+} DatabaseColumns;
+
+void database_columns_init(DatabaseColumns *columns);
+// Baut die Spalten aus db neu auf; bei Fehler bleibt der alte Stand erhalten
+int database_columns_build(DatabaseColumns *columns, const Database *db);
+void database_columns_free(DatabaseColumns *columns);
+int database_columns_find_id(const DatabaseColumns *columns, int id);
+
+#endif
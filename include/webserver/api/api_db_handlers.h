@@ -5,10 +5,10 @@
 #include "webserver/web_core.h"
 #include "webserver/web_parser.h"
 
-void api_db_handle_files(socket_t client);
-void api_db_handle_get(socket_t client, const HttpRequest *req);
-void api_db_handle_add(socket_t client, const HttpRequest *req);
-void api_db_handle_update(socket_t client, const HttpRequest *req);
-void api_db_handle_delete(socket_t client, const HttpRequest *req);
+void api_db_handle_files(HttpClient *client);
+void api_db_handle_get(HttpClient *client, const HttpRequest *req);
+void api_db_handle_add(HttpClient *client, const HttpRequest *req);
+void api_db_handle_update(HttpClient *client, const HttpRequest *req);
+void api_db_handle_delete(HttpClient *client, const HttpRequest *req);
 
 #endif
@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include "database/database_core_defs.h"
+#include "webserver/web_core.h"
 
 #include <stddef.h>
 
@@ -45,5 +46,13 @@ const char *unit_label(UnitType type);
 int parse_int_param(const char *value, int *out);
 DatabaseEntry *find_entry_by_id(Database *db, int id);
 int find_entry_index(const Database *db, int id);
+// Speicher aus der Arena der laufenden Anfrage; sendet bei Fehlschlag selbst 500 und liefert NULL
+void *request_alloc(HttpClient *client, size_t size);
+
+// Serialisiert Zugriffe auf Datenbank- und Listendateien zwischen Worker-Threads
+void api_data_lock_read(void);
+void api_data_unlock_read(void);
+void api_data_lock_write(void);
+void api_data_unlock_write(void);
 
 #endif
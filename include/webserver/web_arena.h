@@ -0,0 +1,37 @@
+#ifndef WEB_ARENA_H
+#define WEB_ARENA_H
+
+// Speicher mit Anfrage-Lebensdauer und wiederverwendbare Pufferblöcke
+#include <stddef.h>
+
+#define WEB_ARENA_BLOCK_SIZE (512u * 1024u)
+#define WEB_ARENA_RETAINED_MAX (4u * 1024u * 1024u)
+
+typedef struct WebArenaBlock WebArenaBlock;
+
+// Bump-Allocator: web_arena_alloc schiebt nur einen Zeiger weiter, web_arena_reset gibt
+// alles auf einmal frei. Eine mit Nullen initialisierte Arena ist gültig und leer.
+typedef struct {
+    WebArenaBlock *current;  // Neuester Block; ältere hängen an ihm
+    size_t next_block;       // Größe des nächsten Blocks, wächst nach Überläufen
+} WebArena;
+
+// Liefert auf 16 Byte ausgerichteten, nicht initialisierten Speicher oder NULL
+void *web_arena_alloc(WebArena *arena, size_t size);
+// Gibt alle Allocations frei. Reichte ein Block nicht, wird beim nächsten Mal einer
+// in der benötigten Gesamtgröße angelegt, damit der Normalfall nur einen Block braucht.
+void web_arena_reset(WebArena *arena);
+void web_arena_destroy(WebArena *arena);
+
+// Größenklassen für Buffer-Speicher: 1 KB bis 256 KB in Zweierpotenzen. Freigegebene Blöcke
+// landen in einer Liste des aufrufenden Threads und werden ohne malloc wiederverwendet.
+#define WEB_BUFFER_POOL_MIN 1024u
+#define WEB_BUFFER_POOL_MAX (256u * 1024u)
+
+// Liefert einen Block mit genau cap Bytes; cap außerhalb der Klassen geht an malloc
+void *web_buffer_pool_acquire(size_t cap);
+void web_buffer_pool_release(void *data, size_t cap);
+// Ist cap eine Größenklasse des Pools?
+int web_buffer_pool_class(size_t cap);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stddef.h>
+
+// Zur Buildzeit eingebettete Frontend-Datei (siehe cmake/EmbedWebAssets.cmake)
+typedef struct {
+    const char *name;          // Pfad relativ zu web/
+    const unsigned char *data;
+    size_t size;
+    const char *content_type;
+    const char *etag;          // SHA-256-Präfix in Anführungszeichen
+} EmbeddedAsset;
+
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    const char *etag;
+} EmbeddedVariant;
+
+// Erzeugt beim Start einmalig die gzip-Varianten der eingebetteten Dateien
+void web_assets_init(void);
+// 1, wenn das Binary mit WEB_EMBED_ASSETS gebaut wurde
+int web_assets_embedded(void);
+// NULL, wenn relative nicht eingebettet ist
+const EmbeddedAsset *web_asset_lookup(const char *relative);
+// 1 und *out gesetzt, wenn für asset eine kleinere gzip-Variante existiert
+int web_asset_gzip_variant(const EmbeddedAsset *asset, EmbeddedVariant *out);
+
+#endif
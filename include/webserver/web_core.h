@@ -5,6 +5,8 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#include "webserver/web_arena.h"
+
 #ifdef _WIN32
 #define _WINSOCK_DEPRECATED_NO_WARNINGS
 #include <winsock2.h>
@@ -29,25 +31,102 @@ typedef struct {
     size_t cap;
 } Buffer;
 
+struct WebDeadline;
+
+typedef struct {
+    socket_t socket;
+    Buffer *out;  // Reaktor-Modus: Antworten werden hier gesammelt statt direkt gesendet
+    int keep_alive; // Verbindung bleibt nach der aktuellen Antwort offen
+    int file_fd;    // Reaktor-Modus: Datei, deren Inhalt nach `out` gesendet wird (-1 = keine)
+    uint64_t file_offset;
+    uint64_t file_remaining;
+    int corked;     // TCP_CORK aktiv: Teilantworten werden zu vollen Paketen gesammelt
+    int holding;    // Worker-Modus: out ist per http_client_hold_output zurückgehaltene Ausgabe
+    int chunked_ok; // Client versteht Transfer-Encoding: chunked (HTTP/1.1)
+    WebArena *arena; // Speicher für die laufende Anfrage, wird nach der Antwort zurückgesetzt
+    int status;     // Statuscode der zuletzt gesendeten Antwort (0 = noch keine)
+    int route_id;   // Metriknummer der bedienenden Route (WEB_METRICS_NO_ROUTE = keine)
+    struct WebDeadline *write_deadline; // Worker-Modus: läuft nur während blockierender Sendevorgänge
+} HttpClient;
+
+#define RESPONSE_STREAM_THRESHOLD 16384
+// Mehr zurückgehaltene Ausgabe wird doch sofort gesendet, siehe http_client_hold_output
+#define HELD_OUTPUT_MAX (1024 * 1024)
+
+// Antwort, die stückweise gesendet wird, statt vollständig im Speicher zu entstehen.
+// Handler schreiben in `body`; response_stream_flush sendet ab RESPONSE_STREAM_THRESHOLD
+// Bytes einen Chunk. Passt alles in einen Chunk, wird normal mit Content-Length gesendet.
+typedef struct {
+    HttpClient *client;
+    Buffer body;
+    const char *status;
+    const char *content_type;
+    int started;    // Kopf ist gesendet
+} ResponseStream;
+
+// Ein Abschnitt einer Antwort für send_segments
+typedef struct {
+    const char *data;
+    size_t len;
+} WebSegment;
+
+void http_client_init(HttpClient *client, socket_t socket, Buffer *out);
+// Hält kleine Schreibvorgänge zurück (corked = 1) bzw. sendet das Gesammelte sofort (0).
+// Im Reaktor-Modus ohne Wirkung, dort wird ohnehin gesammelt gesendet.
+void http_client_set_cork(HttpClient *client, int corked);
+// Worker-Modus: Antworten werden in held gesammelt statt gesendet, bis
+// http_client_release_output sie schickt. So blockiert ein langsamer Client keinen Handler,
+// der Sperren hält. Der Speicher bleibt auf HELD_OUTPUT_MAX begrenzt: größere Antworten werden
+// ab dort blockierend gesendet, der Handler wartet dann bis zur Schreibfrist auf den Client.
+// Im Reaktor-Modus (ohnehin gesammelt) ohne Wirkung.
+void http_client_hold_output(HttpClient *client, Buffer *held);
+void http_client_release_output(HttpClient *client, Buffer *held);
+// Sendet alle Abschnitte mit möglichst einem writev und setzt kurze Schreibvorgänge fort
+void send_segments(HttpClient *client, const WebSegment *segments, size_t count);
+
 int buffer_init(Buffer *buf);
+int buffer_reserve(Buffer *buf, size_t needed);
 int buffer_append(Buffer *buf, const char *data, size_t data_len);
 int buffer_append_str(Buffer *buf, const char *text);
 int buffer_append_char(Buffer *buf, char c);
 int buffer_append_format(Buffer *buf, const char *fmt, ...);
+// Schreiben Zahlen direkt in den Puffer, ohne printf (siehe number_format.h)
+int buffer_append_int(Buffer *buf, long long value);
+int buffer_append_cents(Buffer *buf, long long cents);
+int buffer_append_fixed(Buffer *buf, double value, int decimals);
 void buffer_free(Buffer *buf);
 
+struct stat;
+// Änderungszeit einer Datei in Nanosekunden, soweit das System sie liefert; so fallen auch
+// zwei Schreibvorgänge in derselben Sekunde auf
+long long file_mtime_ns(const struct stat *info);
+
 void append_json_string(Buffer *buf, const char *text);
 
-void send_response_with_headers(socket_t client, const char *status, const char *content_type,
+void send_response_with_headers(HttpClient *client, const char *status, const char *content_type,
                                 const char *body, size_t body_len, const char *extra_headers);
-void send_response(socket_t client, const char *status, const char *content_type,
+// Sendet den Inhalt der geöffneten Datei ohne Kopie in den Userspace; fd wird übernommen
+void send_file_with_headers(HttpClient *client, const char *status, const char *content_type,
+                            int fd, uint64_t size, const char *extra_headers);
+void send_response(HttpClient *client, const char *status, const char *content_type,
                    const char *body, size_t body_len);
-void send_empty_response(socket_t client, const char *status);
-void send_json_response(socket_t client, const char *status, const char *json, size_t len);
-void send_json_string(socket_t client, const char *status, const char *json);
-void send_error(socket_t client, const char *status, const char *message);
-void handle_options(socket_t client);
+void send_empty_response(HttpClient *client, const char *status);
+void send_json_response(HttpClient *client, const char *status, const char *json, size_t len);
+void send_json_string(HttpClient *client, const char *status, const char *json);
+void send_error(HttpClient *client, const char *status, const char *message);
+
+int response_stream_begin(ResponseStream *stream, HttpClient *client, const char *status, const char *content_type);
+void response_stream_flush(ResponseStream *stream);
+void response_stream_end(ResponseStream *stream);
+void handle_options(HttpClient *client);
+
+struct HttpParser;
 
+// Beantwortet die von parser vollständig erkannte Anfrage ab request. client->keep_alive gibt vor,
+// ob die Verbindung eine weitere Anfrage zulässt, und wird auf die tatsächliche Entscheidung gesetzt.
+void serve_http_request(HttpClient *client, char *request, const struct HttpParser *parser);
+// Antwortet auf eine Anfrage, die der Parser abgelehnt hat, und schließt danach die Verbindung
+void send_parse_error(HttpClient *client, const struct HttpParser *parser);
 int run_server(void);
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef WEB_DEADLINE_H
+#define WEB_DEADLINE_H
+
+// Fristen für Verbindungen: wie lange ein Client für Kopf, Body, Leerlauf und das
+// Abholen der Antwort brauchen darf. Der Reaktor führt sie in seinem eigenen Timer-Rad,
+// im Worker-Modus überwacht ein Watchdog-Thread die blockierenden Sockets.
+#include <stdint.h>
+
+#include "webserver/web_core.h"
+#include "webserver/web_parser.h"
+#include "webserver/web_timer.h"
+
+#define WEB_DEADLINE_TICK_US 50000u
+
+typedef enum {
+    WEB_DEADLINE_NONE,
+    WEB_DEADLINE_IDLE,         // Warten auf die nächste Anfrage (Keep-Alive)
+    WEB_DEADLINE_HEADER,
+    WEB_DEADLINE_BODY,
+    WEB_DEADLINE_WRITE
+} WebDeadlineKind;
+
+// Überwachte blockierende Verbindung im Worker-Modus
+typedef struct WebDeadline {
+    WebTimer timer;
+    socket_t socket;
+    WebDeadlineKind kind;
+    WebDeadlineKind expired;   // Frist, die abgelaufen ist (WEB_DEADLINE_NONE = keine)
+} WebDeadline;
+
+uint64_t web_deadline_timeout_us(WebDeadlineKind kind);
+WebDeadlineKind web_deadline_for_phase(HttpReadPhase phase);
+// 1 für Fristen, nach denen der Client noch "408 Request Timeout" bekommen sollte
+int web_deadline_wants_408(WebDeadlineKind kind);
+
+// Startet den Watchdog-Thread; läuft eine Frist ab, weckt shutdown() den blockierten Worker
+int web_watchdog_start(void);
+void web_deadline_init(WebDeadline *deadline, socket_t socket);
+// Setzt die Frist für kind ab jetzt; bleibt die Art gleich, läuft die bisherige Frist weiter
+void web_deadline_set(WebDeadline *deadline, WebDeadlineKind kind);
+// Wie web_deadline_set, die Frist zählt aber ab since_us (web_monotonic_us)
+void web_deadline_set_since(WebDeadline *deadline, WebDeadlineKind kind, uint64_t since_us);
+// Muss vor dem Schließen des Sockets aufgerufen werden
+void web_deadline_clear(WebDeadline *deadline);
+WebDeadlineKind web_deadline_expired(WebDeadline *deadline);
+
+#endif
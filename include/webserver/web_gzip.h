@@ -0,0 +1,13 @@
+#ifndef WEB_GZIP_H
+#define WEB_GZIP_H
+
+#include <stddef.h>
+
+// Komprimiert data als gzip (DEFLATE mit festen Huffman-Codes). Gibt 0 zurück und setzt
+// *out (mit free freizugeben) und *out_size; -1, wenn kein Speicher verfügbar ist.
+int web_gzip_compress(const unsigned char *data, size_t size, unsigned char **out, size_t *out_size);
+
+// 1 für textbasierte Typen, bei denen sich Kompression lohnt
+int web_gzip_worthwhile(const char *content_type);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef WEB_LIMITER_H
+#define WEB_LIMITER_H
+
+// Adaptive Begrenzung gleichzeitig bearbeiteter Anfragen. Ein Platz wird erst für eine
+// vollständig gelesene Anfrage belegt; ruhende oder langsam sendende Verbindungen zählen nicht.
+// Das Limit folgt dem Verhältnis von langfristiger zu aktueller Bearbeitungszeit (Gradient):
+// steigt die Latenz, sinkt es, bei stabiler Latenz wächst es um einen kleinen Spielraum.
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    size_t limit;
+    size_t in_flight;
+    uint64_t admitted;
+    uint64_t rejected;
+    uint64_t short_latency_us;  // Mittel des letzten Messfensters
+    uint64_t long_latency_us;   // Langfristige Basis
+} WebLimiterStats;
+
+void web_limiter_init(void);
+// 1 = Anfrage darf bearbeitet werden (danach web_limiter_release), 0 = abgewiesen
+int web_limiter_try_acquire(void);
+void web_limiter_release(uint64_t latency_us);
+// Zählt eine Abweisung, die außerhalb des Limiters entschieden wurde (z. B. volle Warteschlange)
+void web_limiter_count_rejection(void);
+void web_limiter_stats(WebLimiterStats *out);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef WEB_LOG_H
+#define WEB_LOG_H
+
+// Asynchroner Logger: Anfrage-Threads legen Einträge fester Größe ohne Sperre in einem
+// Ringpuffer ab, ein Hintergrund-Thread formatiert sie und schreibt sie gesammelt.
+// Ist der Puffer voll, wird der Eintrag verworfen statt den Aufrufer warten zu lassen.
+#include <stdint.h>
+
+#include "config.h"
+
+#define WEB_LOG_RING_SIZE 2048     // Zweierpotenz
+#define WEB_LOG_MESSAGE_MAX 448
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WEB_LOG_PRINTF(fmt_index, args_index) __attribute__((format(printf, fmt_index, args_index)))
+#else
+#define WEB_LOG_PRINTF(fmt_index, args_index)
+#endif
+
+// Bis zum Start und nach dem Stopp wird direkt geschrieben
+int web_log_start(void);
+// Schreibt alle wartenden Einträge und beendet den Hintergrund-Thread
+void web_log_stop(void);
+void web_log_message(int level, const char *fmt, ...) WEB_LOG_PRINTF(2, 3);
+// Zugriffsprotokoll: eine Zeile je beantworteter Anfrage (LOG_LEVEL_INFO, g_config.access_log)
+void web_log_access(const char *method, const char *path, int status, uint64_t latency_us);
+
+// Prüft das Level, bevor die Argumente ausgewertet oder formatiert werden
+#define WEB_LOG(level, ...)                          \
+    do {                                             \
+        if ((level) <= g_config.log_level) {         \
+            web_log_message((level), __VA_ARGS__);   \
+        }                                            \
+    } while (0)
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef WEB_METRICS_H
+#define WEB_METRICS_H
+
+// Laufzeitmetriken des Webservers. Jeder Thread schreibt nur in seine eigenen Zähler
+// (ohne Sperren); web_metrics_write_prometheus fasst sie bei Abfrage zusammen.
+#include <stdint.h>
+
+#include "webserver/web_core.h"
+
+#define WEB_METRICS_MAX_ROUTES 32
+#define WEB_METRICS_NO_ROUTE 0   // Anfragen ohne passende Route (404, 405, OPTIONS, 400)
+
+typedef enum {
+    WEB_ERROR_BAD_REQUEST,
+    WEB_ERROR_TIMEOUT,
+    WEB_ERROR_IO,
+    WEB_ERROR_KIND_COUNT
+} WebErrorKind;
+
+// Vergibt eine Nummer für den Routennamen (gleiche Namen teilen sich eine); nur vor dem
+// Start des Servers aufrufen. Liefert WEB_METRICS_NO_ROUTE, wenn die Tabelle voll ist.
+int web_metrics_register_route(const char *name);
+void web_metrics_record_request(int route_id, int status, uint64_t latency_us);
+void web_metrics_add_bytes_in(uint64_t bytes);
+void web_metrics_add_bytes_out(uint64_t bytes);
+void web_metrics_connection_opened(void);
+void web_metrics_connection_closed(void);
+void web_metrics_count_error(WebErrorKind kind);
+// Hängt alle Metriken im Prometheus-Textformat an out an
+int web_metrics_write_prometheus(Buffer *out);
+
+#endif
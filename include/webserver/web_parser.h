@@ -7,20 +7,28 @@
 
 #define MAX_REQUEST_SIZE 65536
 #define MAX_PARAMS 64
-#define MAX_KEY_LEN 64
-#define MAX_VALUE_LEN 512
+#define HTTP_MAX_HEADERS 32
+#define HTTP_MAX_METHOD_LEN 7
 
+// Sicht auf einen Parameter im Empfangspuffer; bereits URL-dekodiert und nullterminiert
 typedef struct {
-    char key[MAX_KEY_LEN];
-    char value[MAX_VALUE_LEN];
+    const char *key;
+    size_t key_len;
+    const char *value;
+    size_t value_len;
 } Param;
 
 typedef struct {
     char method[8];
-    char path[256];
-    char query[512];
+    char *path;                // Zeigt in den Empfangspuffer
+    char *query;               // Roh, ohne '?'; NULL ohne Query
     char content_type[64];
+    char if_none_match[128];
+    char if_modified_since[64];
     size_t content_length;
+    int keep_alive;            // Client wünscht eine persistente Verbindung
+    int http_1_1;              // Client versteht Transfer-Encoding: chunked
+    int accepts_gzip;          // Accept-Encoding erlaubt gzip (q > 0)
     Param query_params[MAX_PARAMS];
     int query_count;
     Param body_params[MAX_PARAMS];
@@ -28,8 +36,90 @@ typedef struct {
     char *body;
 } HttpRequest;
 
-int parse_http_request(char *buffer, size_t length, HttpRequest *req);
-int read_http_request(socket_t client, char *buffer, size_t buffer_size, size_t *out_len);
+// Abschnitt des Empfangspuffers; Offsets zählen ab dem Anfang der Anfrage
+typedef struct {
+    size_t offset;
+    size_t length;
+} HttpSpan;
+
+typedef struct {
+    HttpSpan name;
+    HttpSpan value;            // Ohne führenden und abschließenden Leerraum
+} HttpHeaderSpan;
+
+typedef enum {
+    HTTP_PARSE_REQUEST_START,
+    HTTP_PARSE_METHOD,
+    HTTP_PARSE_TARGET,
+    HTTP_PARSE_VERSION,
+    HTTP_PARSE_LINE_LF,
+    HTTP_PARSE_HEADER_START,
+    HTTP_PARSE_HEADER_NAME,
+    HTTP_PARSE_HEADER_VALUE_START,
+    HTTP_PARSE_HEADER_VALUE,
+    HTTP_PARSE_HEADER_LF,
+    HTTP_PARSE_HEADERS_END_LF,
+    HTTP_PARSE_BODY,
+    HTTP_PARSE_DONE,
+    HTTP_PARSE_ERROR
+} HttpParseState;
+
+// Grund, aus dem der Parser eine Anfrage abgelehnt hat
+typedef enum {
+    HTTP_PARSE_ERROR_NONE,
+    HTTP_PARSE_ERROR_MALFORMED,          // Syntaxfehler, zu groß oder widersprüchliche Längen: 400
+    HTTP_PARSE_ERROR_TRANSFER_ENCODING   // Transfer-Encoding im Request wird nicht unterstützt: 501
+} HttpParseError;
+
+// Fortsetzbarer Parser: jedes Byte des Kopfes wird genau einmal betrachtet,
+// auch wenn die Anfrage über mehrere recv()-Aufrufe eintrifft.
+typedef struct HttpParser {
+    HttpParseState state;
+    HttpParseError error;      // Gesetzt, sobald state HTTP_PARSE_ERROR ist
+    size_t pos;                // Nächstes noch nicht untersuchtes Byte
+    size_t max_size;
+    HttpSpan method;
+    HttpSpan path;
+    HttpSpan query;
+    HttpSpan version;
+    int has_query;
+    HttpHeaderSpan headers[HTTP_MAX_HEADERS];
+    size_t header_count;
+    HttpSpan header_name;      // Zustand des aktuellen Headers
+    size_t value_start;
+    size_t value_end;
+    size_t content_length;
+    int has_content_length;
+    size_t body_offset;
+    size_t request_len;        // Kopf + Body, gültig ab HTTP_PARSE_BODY
+} HttpParser;
+
+// Welche Lesefrist gerade gilt
+typedef enum {
+    HTTP_READ_IDLE,            // Noch kein Byte der nächsten Anfrage
+    HTTP_READ_HEADER,          // Kopf unvollständig
+    HTTP_READ_BODY             // Kopf vollständig, Body steht aus
+} HttpReadPhase;
+
+// Wird nach jedem recv mit dem Parserstand aufgerufen, z. B. um Fristen anzupassen
+typedef void (*http_read_hook)(const HttpParser *parser, size_t buffered, void *context);
+
+void http_parser_init(HttpParser *parser, size_t max_size);
+// Setzt das Parsen mit buffer[parser->pos..length) fort.
+// 1 = vollständige Anfrage (parser->request_len), 0 = weitere Daten nötig, -1 = ungültig oder zu groß
+int http_parser_execute(HttpParser *parser, const char *buffer, size_t length);
+// Füllt req aus einem fertigen Parser; buffer ist derselbe Puffer und wird dabei verändert
+int http_request_from_parser(const HttpParser *parser, char *buffer, HttpRequest *req);
+HttpReadPhase http_parser_phase(const HttpParser *parser, size_t buffered);
+// 1, wenn die Anfrage vollständig ist und ihr Ende eindeutig feststeht; nur dann dürfen
+// die folgenden Bytes als nächste Anfrage derselben Verbindung gelesen werden
+int http_parser_body_framed(const HttpParser *parser);
+// Liest, bis buffer eine vollständige Anfrage enthält. *buffered enthält beim Aufruf bereits
+// vorhandene Bytes (Pipelining) und danach alle empfangenen Bytes; parser behält seinen Stand.
+// 0 = Anfrage gelesen, 1 = Verbindung ohne neue Anfrage beendet, -1 = Fehler.
+// hook darf NULL sein.
+int read_http_request(socket_t client, char *buffer, size_t buffer_size, size_t *buffered, HttpParser *parser,
+                      http_read_hook hook, void *context);
 const char *find_param(const Param *params, int count, const char *key);
 
 #endif
@@ -0,0 +1,29 @@
+#ifndef WEB_POOL_H
+#define WEB_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "webserver/web_core.h"
+
+// Wird von einem Worker für jede angenommene Verbindung aufgerufen;
+// wait_us ist die Zeit, die die Verbindung in der Warteschlange lag.
+typedef void (*web_connection_handler)(socket_t client, uint64_t wait_us);
+
+typedef struct {
+    uint64_t dequeued;        // Anzahl abgeholter Verbindungen
+    uint64_t total_wait_us;   // Summe aller Wartezeiten
+    uint64_t max_wait_us;     // Längste Wartezeit
+    size_t queued;            // Aktuell wartende Verbindungen
+    size_t busy_workers;      // Aktuell arbeitende Worker
+    size_t workers;
+    size_t queue_depth;
+} WebPoolStats;
+
+int web_pool_start(size_t worker_count, size_t queue_depth, web_connection_handler handler);
+// Reiht die Verbindung ein, ohne zu warten: -1, wenn die Warteschlange voll ist
+int web_pool_try_submit(socket_t client);
+void web_pool_stats(WebPoolStats *out);
+size_t web_pool_pending(void);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef WEB_REACTOR_H
+#define WEB_REACTOR_H
+
+#include "webserver/web_core.h"
+
+// Ereignisschleife mit epoll und nicht-blockierenden Sockets (nur Linux).
+// Handler laufen direkt im Reaktor-Thread; Antworten werden je Verbindung gepuffert.
+int web_reactor_supported(void);
+// Kehrt nur im Fehlerfall zurück (-1)
+int run_reactor(socket_t server);
+
+#endif
@@ -4,6 +4,25 @@
 #include "webserver/web_core.h"
 #include "webserver/web_parser.h"
 
-void route_request(socket_t client, const HttpRequest *req);
+#define ROUTE_GET  0x1u
+#define ROUTE_POST 0x2u
+
+typedef void (*web_route_handler)(HttpClient *client, const HttpRequest *req);
+
+typedef struct {
+    const char *path;
+    unsigned methods;          // Bitmaske aus ROUTE_GET/ROUTE_POST
+    int prefix;                // Passt auch auf alle Pfade, die mit path beginnen
+    web_route_handler handler;
+} WebRoute;
+
+// Trägt Routen in den Radix-Baum ein; nur vor dem Start des Servers aufrufen.
+// Die Einträge müssen bis zum Programmende gültig bleiben.
+int web_router_register(const WebRoute *routes, size_t count);
+// Registriert die Routen aller Module
+int web_router_init(void);
+// Sucht die Route für path (exakte Treffer vor dem längsten Präfix) und ruft ihren Handler auf;
+// 405 mit Allow-Kopf, wenn der Pfad die Methode nicht bedient
+void route_request(HttpClient *client, const HttpRequest *req);
 
 #endif
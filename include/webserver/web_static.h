@@ -4,10 +4,13 @@
 #include <stddef.h>
 
 #include "webserver/web_core.h"
+#include "webserver/web_parser.h"
 
 int build_static_path(const char *relative, char *out, size_t out_size);
-void send_file_response(socket_t client, const char *path);
-void handle_static_root(socket_t client);
-void handle_static_request(socket_t client, const char *relative);
+void send_file_response(HttpClient *client, const char *path);
+void handle_static_root(HttpClient *client, const HttpRequest *req);
+void handle_static_request(HttpClient *client, const HttpRequest *req, const char *relative);
+// Registriert "/" und das Präfix "/static/"
+int web_static_register_routes(void);
 
 #endif
@@ -0,0 +1,45 @@
+#ifndef WEB_STATIC_CACHE_H
+#define WEB_STATIC_CACHE_H
+
+#include "webserver/web_thread.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define STATIC_CACHE_MAX_PATH 512
+
+typedef struct StaticAsset {
+    char path[STATIC_CACHE_MAX_PATH];
+    char *data;
+    size_t size;
+    char *gzip_data;         // NULL, wenn Kompression sich nicht lohnt
+    size_t gzip_size;
+    time_t mtime;
+    long long mtime_ns;      // Für die Prüfung auf Änderungen, siehe file_mtime_ns
+    char etag[24];           // Inhalts-Hash in Anführungszeichen
+    char gzip_etag[28];      // Eigenes ETag für die gzip-Darstellung
+    char last_modified[32];  // IMF-fixdate
+    const char *content_type;
+    web_refcount_t refcount; // Eine Referenz hält der Cache selbst, solange der Eintrag drin ist
+} StaticAsset;
+
+typedef enum {
+    STATIC_CACHE_HIT,
+    STATIC_CACHE_NOT_FOUND,
+    STATIC_CACHE_BYPASS      // Zu groß oder Cache voll: direkt von der Platte senden
+} StaticCacheResult;
+
+// Liefert den Inhalt von path aus dem Speicher und lädt ihn neu, wenn sich mtime oder Größe
+// geändert haben. Bei STATIC_CACHE_HIT muss *out mit static_cache_release freigegeben werden.
+StaticCacheResult static_cache_acquire(const char *path, const char *content_type, StaticAsset **out);
+void static_cache_release(StaticAsset *asset);
+
+// 1, wenn die Liste in If-None-Match das ETag (oder "*") enthält
+int static_etag_matches(const char *if_none_match, const char *etag);
+// 1, wenn If-None-Match bzw. If-Modified-Since zur gecachten Version passen;
+// gzip wählt, gegen welches ETag verglichen wird
+int static_asset_not_modified(const StaticAsset *asset, int gzip, const char *if_none_match,
+                              const char *if_modified_since);
+
+#endif
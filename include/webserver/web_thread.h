@@ -0,0 +1,80 @@
+#ifndef WEB_THREAD_H
+#define WEB_THREAD_H
+
+// Dünne Abstraktion über Threads, Locks und Zeitmessung (POSIX und Windows)
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+typedef HANDLE web_thread_t;
+typedef CRITICAL_SECTION web_mutex_t;
+typedef CONDITION_VARIABLE web_cond_t;
+typedef SRWLOCK web_rwlock_t;
+#define WEB_RWLOCK_INIT SRWLOCK_INIT
+#else
+#include <pthread.h>
+typedef pthread_t web_thread_t;
+typedef pthread_mutex_t web_mutex_t;
+typedef pthread_cond_t web_cond_t;
+typedef pthread_rwlock_t web_rwlock_t;
+#define WEB_RWLOCK_INIT PTHREAD_RWLOCK_INITIALIZER
+#endif
+
+#ifdef _MSC_VER
+#define WEB_THREAD_LOCAL __declspec(thread)
+typedef volatile LONG web_refcount_t;
+typedef volatile LONG64 web_counter_t;
+#else
+#include <stdatomic.h>
+#define WEB_THREAD_LOCAL _Thread_local
+typedef atomic_int web_refcount_t;
+typedef _Atomic uint64_t web_counter_t;
+#endif
+
+typedef void (*web_thread_fn)(void *arg);
+
+int web_thread_start(web_thread_t *thread, web_thread_fn fn, void *arg);
+void web_thread_join(web_thread_t thread);
+
+void web_mutex_init(web_mutex_t *mutex);
+void web_mutex_lock(web_mutex_t *mutex);
+void web_mutex_unlock(web_mutex_t *mutex);
+
+void web_cond_init(web_cond_t *cond);
+void web_cond_wait(web_cond_t *cond, web_mutex_t *mutex);
+void web_cond_signal(web_cond_t *cond);
+
+void web_rwlock_read_lock(web_rwlock_t *lock);
+void web_rwlock_read_unlock(web_rwlock_t *lock);
+void web_rwlock_write_lock(web_rwlock_t *lock);
+void web_rwlock_write_unlock(web_rwlock_t *lock);
+
+// Atomarer Referenzzähler; erlaubt das Teilen von Cache-Einträgen unter einer Lesesperre
+void web_refcount_set(web_refcount_t *count, int value);
+void web_refcount_retain(web_refcount_t *count);
+// 1, wenn dies die letzte Referenz war
+int web_refcount_drop(web_refcount_t *count);
+int web_refcount_get(web_refcount_t *count);
+
+// Atomarer 64-Bit-Zähler, z. B. für LRU-Zeitstempel unter einer Lesesperre
+uint64_t web_counter_load(web_counter_t *counter);
+void web_counter_store(web_counter_t *counter, uint64_t value);
+// Erhöht um eins und liefert den neuen Wert
+uint64_t web_counter_next(web_counter_t *counter);
+
+// Bindet den aufrufenden Thread an eine CPU; -1, wenn nicht unterstützt
+int web_thread_pin_to_cpu(size_t cpu);
+// Liefert in *cpu die Nummer der n-ten CPU (modulo ihrer Anzahl), auf der der aufrufende
+// Thread laufen darf; berücksichtigt cpusets und Affinitätsmasken. -1, wenn unbekannt.
+int web_thread_allowed_cpu(size_t n, size_t *cpu);
+
+void web_sleep_ms(unsigned milliseconds);
+
+// Anzahl der logischen CPUs, die der Prozess nutzen darf (mindestens 1)
+size_t web_cpu_count(void);
+// Monotone Uhr in Mikrosekunden
+uint64_t web_monotonic_us(void);
+
+#endif
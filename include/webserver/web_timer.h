@@ -0,0 +1,43 @@
+#ifndef WEB_TIMER_H
+#define WEB_TIMER_H
+
+// Hierarchisches Timer-Rad: Einfügen, Entfernen und Ablauf kosten O(1) je Timer,
+// unabhängig davon, wie viele Verbindungen gerade eine Frist haben.
+#include <stddef.h>
+#include <stdint.h>
+
+#define WEB_TIMER_LEVELS 4
+#define WEB_TIMER_SLOT_BITS 6
+#define WEB_TIMER_SLOTS (1u << WEB_TIMER_SLOT_BITS)
+
+// In die überwachte Struktur eingebettet; nicht in einer Liste, solange next == NULL
+typedef struct WebTimer {
+    struct WebTimer *next;
+    struct WebTimer *prev;
+    uint64_t expires;          // In Ticks
+} WebTimer;
+
+typedef struct {
+    WebTimer slots[WEB_TIMER_LEVELS][WEB_TIMER_SLOTS];  // Listenköpfe
+    uint64_t current;          // Nächster zu verarbeitender Tick
+    uint64_t start_us;
+    uint64_t tick_us;
+    size_t count;
+} WebTimerWheel;
+
+// Wird für jeden abgelaufenen Timer aufgerufen; der Timer ist dann bereits ausgehängt
+// und darf neu geplant werden
+typedef void (*web_timer_fn)(WebTimer *timer, void *context);
+
+void web_timer_wheel_init(WebTimerWheel *wheel, uint64_t now_us, uint64_t tick_us);
+void web_timer_init(WebTimer *timer);
+int web_timer_pending(const WebTimer *timer);
+// Plant den Timer für deadline_us (monotone Zeit) ein; ein geplanter Timer wird verschoben
+void web_timer_schedule(WebTimerWheel *wheel, WebTimer *timer, uint64_t deadline_us);
+void web_timer_cancel(WebTimerWheel *wheel, WebTimer *timer);
+// Verarbeitet alle Ticks bis now_us und liefert die Anzahl abgelaufener Timer
+size_t web_timer_advance(WebTimerWheel *wheel, uint64_t now_us, web_timer_fn fn, void *context);
+// Millisekunden bis zum nächsten Tick, der etwas zu tun hat; -1 ohne geplante Timer
+int web_timer_next_timeout_ms(const WebTimerWheel *wheel, uint64_t now_us);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef WEB_TRACE_H
+#define WEB_TRACE_H
+
+// Phasenzeiten einzelner Anfragen. Nur mit WEB_TRACE_ENABLED (CMake-Option WEB_TRACE)
+// einkompiliert; sonst werden alle Sonden zu leeren Anweisungen.
+// Anfragen über g_config.slow_request_ms landen mit Aufschlüsselung im Slow-Request-Log.
+// Zeit wird immer der innersten offenen Phase zugerechnet, Phasen können also geschachtelt werden.
+
+typedef enum {
+    WEB_TRACE_READ,            // Erstes Byte bis vollständige Anfrage (nur Worker-Modus)
+    WEB_TRACE_PARSE,
+    WEB_TRACE_RESOLVE_PATH,
+    WEB_TRACE_LOAD_DATABASE,
+    WEB_TRACE_LOAD_LIST,
+    WEB_TRACE_COMPARE,
+    WEB_TRACE_SERIALIZE,
+    WEB_TRACE_SEND,
+    WEB_TRACE_HANDLER,         // Übrige Zeit zwischen Parser und Antwort
+    WEB_TRACE_PHASE_COUNT
+} WebTracePhase;
+
+#ifdef WEB_TRACE_ENABLED
+
+// Beginnt eine neue Messung; das erste Byte einer Anfrage ist gerade eingetroffen
+void web_trace_first_byte(void);
+// Die Anfrage ist vollständig; startet die Messung, falls noch keine läuft (Pipelining, Reaktor)
+void web_trace_request_begin(void);
+void web_trace_enter(WebTracePhase phase);
+void web_trace_leave(void);
+// Schließt die Messung ab und protokolliert sie, wenn sie die Schwelle überschreitet
+void web_trace_request_end(const char *method, const char *path, int status);
+
+#define WEB_TRACE_FIRST_BYTE() web_trace_first_byte()
+#define WEB_TRACE_REQUEST_BEGIN() web_trace_request_begin()
+#define WEB_TRACE_ENTER(phase) web_trace_enter(phase)
+#define WEB_TRACE_LEAVE() web_trace_leave()
+#define WEB_TRACE_REQUEST_END(method, path, status) web_trace_request_end((method), (path), (status))
+
+#else
+
+#define WEB_TRACE_FIRST_BYTE() ((void)0)
+#define WEB_TRACE_REQUEST_BEGIN() ((void)0)
+#define WEB_TRACE_ENTER(phase) ((void)0)
+#define WEB_TRACE_LEAVE() ((void)0)
+#define WEB_TRACE_REQUEST_END(method, path, status) ((void)0)
+
+#endif
+
+#endif
@@ -10,12 +10,59 @@ void config_init(void) {
     g_config.log_level = CONFIG_DEFAULT_LOG_LEVEL;
     g_config.max_articles = CONFIG_DEFAULT_MAX_ARTICLES;
     g_config.max_string_length = CONFIG_DEFAULT_MAX_STRING_LENGTH;
+    g_config.server_mode = CONFIG_DEFAULT_SERVER_MODE;
+    g_config.listener_shards = CONFIG_DEFAULT_LISTENER_SHARDS;
+    g_config.worker_threads = CONFIG_DEFAULT_WORKER_THREADS;
+    g_config.connection_queue_depth = CONFIG_DEFAULT_CONNECTION_QUEUE_DEPTH;
+    g_config.listen_backlog = CONFIG_DEFAULT_LISTEN_BACKLOG;
+    g_config.concurrency_limit_initial = CONFIG_DEFAULT_CONCURRENCY_LIMIT_INITIAL;
+    g_config.concurrency_limit_min = CONFIG_DEFAULT_CONCURRENCY_LIMIT_MIN;
+    g_config.concurrency_limit_max = CONFIG_DEFAULT_CONCURRENCY_LIMIT_MAX;
+    g_config.keepalive_timeout_ms = CONFIG_DEFAULT_KEEPALIVE_TIMEOUT_MS;
+    g_config.keepalive_max_requests = CONFIG_DEFAULT_KEEPALIVE_MAX_REQUESTS;
+    g_config.header_timeout_ms = CONFIG_DEFAULT_HEADER_TIMEOUT_MS;
+    g_config.body_timeout_ms = CONFIG_DEFAULT_BODY_TIMEOUT_MS;
+    g_config.write_timeout_ms = CONFIG_DEFAULT_WRITE_TIMEOUT_MS;
+    g_config.access_log = CONFIG_DEFAULT_ACCESS_LOG;
+    g_config.slow_request_ms = CONFIG_DEFAULT_SLOW_REQUEST_MS;
+    g_config.static_cache_max_bytes = CONFIG_DEFAULT_STATIC_CACHE_MAX_BYTES;
+    g_config.static_cache_max_file_size = CONFIG_DEFAULT_STATIC_CACHE_MAX_FILE_SIZE;
 }
 
 void print_config(void) {
     printf("Aktuelle Konfiguration:\n");
     printf("  Webserver-Port      : %d\n", g_config.webserver_port);
-    printf("  Log-Level           : %d\n", g_config.log_level);
+    printf("  Log-Level           : %d, Zugriffsprotokoll %s\n", g_config.log_level,
+           g_config.access_log ? "an" : "aus");
     printf("  Maximale Artikelanzahl: %zu\n", g_config.max_articles);
     printf("  Maximale String-Länge : %zu\n", g_config.max_string_length);
+    printf("  Server-Modus        : %s\n",
+           g_config.server_mode == CONFIG_SERVER_MODE_EPOLL ? "epoll-Reaktor" : "Worker-Threads");
+    printf("  Listener-Shards     : %zu%s\n", g_config.listener_shards,
+           g_config.listener_shards == 0 ? " (je CPU-Kern)" : "");
+    printf("  Worker-Threads      : %zu%s\n", g_config.worker_threads,
+           g_config.worker_threads == 0 ? " (automatisch)" : "");
+    printf("  Warteschlangentiefe : %zu, Listen-Backlog %d\n", g_config.connection_queue_depth,
+           g_config.listen_backlog);
+    if (g_config.concurrency_limit_max == 0) {
+        printf("  Anfragelimit        : aus\n");
+    } else {
+        printf("  Anfragelimit        : adaptiv, Start %zu (%zu bis %zu)\n", g_config.concurrency_limit_initial,
+               g_config.concurrency_limit_min, g_config.concurrency_limit_max);
+    }
+    printf("  Keep-Alive          : %d ms, max. %d Anfragen\n",
+           g_config.keepalive_timeout_ms, g_config.keepalive_max_requests);
+    printf("  Fristen             : Kopf %d ms, Body %d ms, Senden %d ms\n",
+           g_config.header_timeout_ms, g_config.body_timeout_ms, g_config.write_timeout_ms);
+#ifdef WEB_TRACE_ENABLED
+    if (g_config.slow_request_ms < 0) {
+        printf("  Slow-Request-Log    : aus\n");
+    } else {
+        printf("  Slow-Request-Log    : ab %d ms\n", g_config.slow_request_ms);
+    }
+#else
+    printf("  Slow-Request-Log    : nicht einkompiliert (WEB_TRACE)\n");
+#endif
+    printf("  Static-Cache        : %zu Bytes, max. %zu Bytes je Datei\n",
+           g_config.static_cache_max_bytes, g_config.static_cache_max_file_size);
 }
@@ -1,5 +1,6 @@
 #include "database/csv_database_utils.h"
 
+#include "database/database_storage_utils.h"
 #include "database/quantity_unit_utils.h"
 #include "database/text_input_utils.h"
 
@@ -31,6 +32,29 @@ int hat_csv_endung(const char *name) {
     return 0;
 }
 
+// Liest eine Zeile beliebiger Länge; der Puffer wächst bei Bedarf mit
+static int lies_zeile(FILE *datei, char **puffer, size_t *groesse) {
+    size_t laenge = 0;
+    for (;;) {
+        if (*groesse - laenge < 2) {
+            size_t neue_groesse = *groesse > 0 ? *groesse * 2 : 512;
+            char *neu = (char *)realloc(*puffer, neue_groesse);
+            if (neu == NULL) {
+                return -1;
+            }
+            *puffer = neu;
+            *groesse = neue_groesse;
+        }
+        if (fgets(*puffer + laenge, (int)(*groesse - laenge), datei) == NULL) {
+            return laenge > 0 ? 0 : 1;
+        }
+        laenge += strlen(*puffer + laenge);
+        if (laenge > 0 && (*puffer)[laenge - 1] == '\n') {
+            return 0;
+        }
+    }
+}
+
 int lade_datenbank(const char *dateipfad, Datenbank *datenbank) {
     if (dateipfad == NULL || datenbank == NULL) {
         return -1;
@@ -39,11 +63,13 @@ int lade_datenbank(const char *dateipfad, Datenbank *datenbank) {
     if (datei == NULL) {
         return -1;
     }
-    datenbank->anzahl = 0;
+    datenbank_init(datenbank);
     strncpy(datenbank->dateiname, dateipfad, DB_MAX_DATEINAME - 1);
     datenbank->dateiname[DB_MAX_DATEINAME - 1] = '\0';
-    char zeile[512];
-    while (fgets(zeile, sizeof zeile, datei) != NULL) {
+    char *zeile = NULL;
+    size_t zeilen_groesse = 0;
+    int status;
+    while ((status = lies_zeile(datei, &zeile, &zeilen_groesse)) == 0) {
         zeile[strcspn(zeile, "\r\n")] = '\0';
         if (zeile[0] == '\0') {
             continue;
@@ -56,7 +82,7 @@ int lade_datenbank(const char *dateipfad, Datenbank *datenbank) {
             feldanzahl++;
             teil = strtok(NULL, ",");
         }
-        if (feldanzahl != 6 || datenbank->anzahl >= DB_MAX_EINTRAEGE) {
+        if (feldanzahl != 6) {
             continue;
         }
         for (int feld_index = 0; feld_index < 6; feld_index++) {
@@ -79,21 +105,31 @@ int lade_datenbank(const char *dateipfad, Datenbank *datenbank) {
         if (mengenwert < 0.0) {
             continue;
         }
-        DatenbankEintrag *eintrag = &datenbank->eintraege[datenbank->anzahl];
-        datenbank->anzahl++;
+        char einheit[8];
+        if (normalisiere_mengeneinheit(felder[5], einheit, sizeof einheit, &mengenwert) != 0) {
+            continue;
+        }
+        DatenbankEintrag *eintrag = datenbank_neuer_eintrag(datenbank);
+        if (eintrag == NULL) {
+            status = -1;
+            break;
+        }
         eintrag->id = (int)kennung;
-        strncpy(eintrag->artikel, felder[1], DB_MAX_TEXTLAENGE - 1);
-        eintrag->artikel[DB_MAX_TEXTLAENGE - 1] = '\0';
-        strncpy(eintrag->anbieter, felder[2], DB_MAX_TEXTLAENGE - 1);
-        eintrag->anbieter[DB_MAX_TEXTLAENGE - 1] = '\0';
+        if (datenbank_text_internieren(datenbank, felder[1], &eintrag->artikel_id) != 0 ||
+            datenbank_text_internieren(datenbank, felder[2], &eintrag->anbieter_id) != 0) {
+            status = -1;
+            break;
+        }
         eintrag->preis_ct = (int)preis;
         eintrag->menge_wert = mengenwert;
-        if (normalisiere_mengeneinheit(felder[5], eintrag->menge_einheit, sizeof eintrag->menge_einheit, &eintrag->menge_wert) != 0) {
-            datenbank->anzahl--;
-            continue;
-        }
+        memcpy(eintrag->menge_einheit, einheit, sizeof einheit);
     }
+    free(zeile);
     fclose(datei);
+    if (status < 0) {
+        datenbank_freigeben(datenbank);
+        return -1;
+    }
     return 0;
 }
 
@@ -109,7 +145,8 @@ int speichere_datenbank(const Datenbank *datenbank) {
         const DatenbankEintrag *eintrag = &datenbank->eintraege[eintrags_index];
         char mengen_text[32];
         formatiere_mengenwert(eintrag->menge_wert, mengen_text, sizeof mengen_text);
-        fprintf(datei, "%d,%s,%s,%d,%s,%s\n", eintrag->id, eintrag->artikel, eintrag->anbieter, eintrag->preis_ct, mengen_text, eintrag->menge_einheit);
+        fprintf(datei, "%d,%s,%s,%d,%s,%s\n", eintrag->id, datenbank_text(datenbank, eintrag->artikel_id),
+                datenbank_text(datenbank, eintrag->anbieter_id), eintrag->preis_ct, mengen_text, eintrag->menge_einheit);
     }
     fclose(datei);
     return 0;
@@ -10,6 +10,10 @@ int save_database(const Datenbank *datenbank) {
     return speichere_datenbank(datenbank);
 }
 
+void free_database(Datenbank *datenbank) {
+    datenbank_freigeben(datenbank);
+}
+
 int list_csv_files(const char *verzeichnis, char dateien[][DB_MAX_DATEINAME], int max_dateien) {
     return liste_csv_dateien(verzeichnis, dateien, max_dateien);
 }
@@ -0,0 +1,162 @@
+#include "database/database_storage_utils.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Eintragsliste mit Verdopplung; Texte einmal pro Datenbank in großen Blöcken,
+// Einträge verweisen über das Wörterbuch per Id darauf
+
+#define DB_WOERTERBUCH_START_PLAETZE 256
+
+void datenbank_init(Datenbank *datenbank) {
+    datenbank->eintraege = NULL;
+    datenbank->anzahl = 0;
+    datenbank->kapazitaet = 0;
+    datenbank->texte = NULL;
+    memset(&datenbank->woerterbuch, 0, sizeof datenbank->woerterbuch);
+    datenbank->dateiname[0] = '\0';
+}
+
+void datenbank_freigeben(Datenbank *datenbank) {
+    if (datenbank == NULL) {
+        return;
+    }
+    DatenbankTextblock *block = datenbank->texte;
+    while (block != NULL) {
+        DatenbankTextblock *naechster = block->naechster;
+        free(block);
+        block = naechster;
+    }
+    free((void *)datenbank->woerterbuch.texte);
+    free(datenbank->woerterbuch.plaetze);
+    free(datenbank->eintraege);
+    datenbank_init(datenbank);
+}
+
+DatenbankEintrag *datenbank_neuer_eintrag(Datenbank *datenbank) {
+    if (datenbank->anzahl == datenbank->kapazitaet) {
+        if (datenbank->kapazitaet > INT_MAX / 2) {
+            return NULL;
+        }
+        int neue_kapazitaet = datenbank->kapazitaet > 0 ? datenbank->kapazitaet * 2 : DB_START_KAPAZITAET;
+        DatenbankEintrag *neu = (DatenbankEintrag *)realloc(datenbank->eintraege,
+                                                            (size_t)neue_kapazitaet * sizeof *neu);
+        if (neu == NULL) {
+            return NULL;
+        }
+        datenbank->eintraege = neu;
+        datenbank->kapazitaet = neue_kapazitaet;
+    }
+    DatenbankEintrag *eintrag = &datenbank->eintraege[datenbank->anzahl];
+    datenbank->anzahl++;
+    memset(eintrag, 0, sizeof *eintrag);
+    return eintrag;
+}
+
+static char *text_speichern(Datenbank *datenbank, const char *text, size_t laenge) {
+    DatenbankTextblock *block = datenbank->texte;
+    if (block == NULL || block->groesse - block->belegt < laenge) {
+        size_t groesse = laenge > DB_TEXTBLOCK_GROESSE ? laenge : DB_TEXTBLOCK_GROESSE;
+        block = (DatenbankTextblock *)malloc(sizeof *block + groesse);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->naechster = datenbank->texte;
+        block->belegt = 0;
+        block->groesse = groesse;
+        datenbank->texte = block;
+    }
+    char *kopie = block->daten + block->belegt;
+    memcpy(kopie, text, laenge);
+    block->belegt += laenge;
+    return kopie;
+}
+
+static uint32_t text_hash(const char *text) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *zeichen = (const unsigned char *)text; *zeichen != '\0'; zeichen++) {
+        hash ^= *zeichen;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Platz für text: entweder der mit seiner Id oder der freie, an dem er eingefügt würde
+static uint32_t finde_platz(const DatenbankWoerterbuch *woerterbuch, const char *text) {
+    uint32_t maske = woerterbuch->platz_anzahl - 1;
+    uint32_t platz = text_hash(text) & maske;
+    while (woerterbuch->plaetze[platz] != 0 &&
+           strcmp(woerterbuch->texte[woerterbuch->plaetze[platz] - 1], text) != 0) {
+        platz = (platz + 1) & maske;
+    }
+    return platz;
+}
+
+static int woerterbuch_vergroessern(DatenbankWoerterbuch *woerterbuch) {
+    if (woerterbuch->platz_anzahl > UINT32_MAX / 2) {
+        return -1;
+    }
+    uint32_t neue_anzahl = woerterbuch->platz_anzahl > 0 ? woerterbuch->platz_anzahl * 2
+                                                         : DB_WOERTERBUCH_START_PLAETZE;
+    uint32_t *plaetze = (uint32_t *)calloc(neue_anzahl, sizeof *plaetze);
+    if (plaetze == NULL) {
+        return -1;
+    }
+    free(woerterbuch->plaetze);
+    woerterbuch->plaetze = plaetze;
+    woerterbuch->platz_anzahl = neue_anzahl;
+    for (uint32_t id = 0; id < woerterbuch->anzahl; id++) {
+        woerterbuch->plaetze[finde_platz(woerterbuch, woerterbuch->texte[id])] = id + 1;
+    }
+    return 0;
+}
+
+int datenbank_text_internieren(Datenbank *datenbank, const char *text, uint32_t *id) {
+    DatenbankWoerterbuch *woerterbuch = &datenbank->woerterbuch;
+    // Füllgrad höchstens 3/4, damit die Suchketten kurz bleiben
+    if ((uint64_t)(woerterbuch->anzahl + 1) * 4 > (uint64_t)woerterbuch->platz_anzahl * 3 &&
+        woerterbuch_vergroessern(woerterbuch) != 0) {
+        return -1;
+    }
+    uint32_t platz = finde_platz(woerterbuch, text);
+    if (woerterbuch->plaetze[platz] != 0) {
+        *id = woerterbuch->plaetze[platz] - 1;
+        return 0;
+    }
+    if (woerterbuch->anzahl == woerterbuch->kapazitaet) {
+        if (woerterbuch->kapazitaet >= DB_KEIN_TEXT / 2) {
+            return -1;
+        }
+        uint32_t neue_kapazitaet = woerterbuch->kapazitaet > 0 ? woerterbuch->kapazitaet * 2 : 64;
+        const char **texte = (const char **)realloc((void *)woerterbuch->texte,
+                                                    (size_t)neue_kapazitaet * sizeof *texte);
+        if (texte == NULL) {
+            return -1;
+        }
+        woerterbuch->texte = texte;
+        woerterbuch->kapazitaet = neue_kapazitaet;
+    }
+    const char *kopie = text_speichern(datenbank, text, strlen(text) + 1);
+    if (kopie == NULL) {
+        return -1;
+    }
+    woerterbuch->texte[woerterbuch->anzahl] = kopie;
+    woerterbuch->plaetze[platz] = woerterbuch->anzahl + 1;
+    *id = woerterbuch->anzahl;
+    woerterbuch->anzahl++;
+    return 0;
+}
+
+uint32_t datenbank_text_suchen(const Datenbank *datenbank, const char *text) {
+    const DatenbankWoerterbuch *woerterbuch = &datenbank->woerterbuch;
+    if (woerterbuch->platz_anzahl == 0) {
+        return DB_KEIN_TEXT;
+    }
+    uint32_t platz = finde_platz(woerterbuch, text);
+    return woerterbuch->plaetze[platz] != 0 ? woerterbuch->plaetze[platz] - 1 : DB_KEIN_TEXT;
+}
+
+const char *datenbank_text(const Datenbank *datenbank, uint32_t id) {
+    return id < datenbank->woerterbuch.anzahl ? datenbank->woerterbuch.texte[id] : "";
+}
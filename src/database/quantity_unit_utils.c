@@ -1,7 +1,8 @@
 #include "database/quantity_unit_utils.h"
 
+#include "number_format.h"
+
 #include <ctype.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -11,7 +12,10 @@ void formatiere_mengenwert(double wert, char *ziel, size_t groesse) {
     if (ziel == NULL || groesse == 0) {
         return;
     }
-    snprintf(ziel, groesse, "%.6f", wert);
+    char text[NUMBER_FORMAT_MAX];
+    format_fixed(wert, 6, text);
+    strncpy(ziel, text, groesse - 1);
+    ziel[groesse - 1] = '\0';
     char *komma = strchr(ziel, '.');
     if (komma == NULL) {
         return;
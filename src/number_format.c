@@ -0,0 +1,124 @@
+#include "number_format.h"
+
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Bis hierhin ist value * 10^decimals auf etwa 1e-6 genau, siehe format_fixed
+#define FIXED_FAST_LIMIT 1e10
+#define FIXED_TIE_WINDOW 1e-5
+
+static const unsigned long long POWERS_OF_TEN[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull,
+    1000000ull, 10000000ull, 100000000ull, 1000000000ull
+};
+
+static size_t write_unsigned(unsigned long long value, char *out) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+    out[count] = '\0';
+    return count;
+}
+
+// Schreibt exakt `width` Ziffern mit führenden Nullen
+static void write_padded(unsigned long long value, int width, char *out) {
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    out[width] = '\0';
+}
+
+size_t format_integer(long long value, char *out) {
+    if (value < 0) {
+        out[0] = '-';
+        // Über unsigned, damit auch LLONG_MIN funktioniert
+        return 1 + write_unsigned(0ull - (unsigned long long)value, out + 1);
+    }
+    return write_unsigned((unsigned long long)value, out);
+}
+
+size_t format_cents(long long cents, char *out) {
+    size_t len = 0;
+    unsigned long long magnitude = (unsigned long long)cents;
+    if (cents < 0) {
+        out[len++] = '-';
+        magnitude = 0ull - magnitude;
+    }
+    len += write_unsigned(magnitude / 100, out + len);
+    out[len++] = '.';
+    write_padded(magnitude % 100, 2, out + len);
+    return len + 2;
+}
+
+// printf schreibt den Dezimaltrenner der Locale; hier wie im schnellen Weg immer '.'
+static size_t use_decimal_point(char *out, size_t len) {
+    const char *separator = localeconv()->decimal_point;
+    size_t separator_len = strlen(separator);
+    if (separator_len == 0 || strcmp(separator, ".") == 0) {
+        return len;
+    }
+    char *found = strstr(out, separator);
+    if (found == NULL) {
+        return len;
+    }
+    *found = '.';
+    memmove(found + 1, found + separator_len, len - (size_t)(found - out) - separator_len + 1);
+    return len - separator_len + 1;
+}
+
+static size_t format_with_printf(double value, int decimals, char *out) {
+    int written = snprintf(out, NUMBER_FORMAT_MAX, "%.*f", decimals, value);
+    if (written >= NUMBER_FORMAT_MAX) {
+        // Passt nicht (z. B. 1e300): lieber Exponentenschreibweise als abgeschnittene Ziffern
+        written = snprintf(out, NUMBER_FORMAT_MAX, "%.17g", value);
+    }
+    if (written <= 0 || written >= NUMBER_FORMAT_MAX) {
+        out[0] = '\0';
+        return 0;
+    }
+    return use_decimal_point(out, (size_t)written);
+}
+
+size_t format_fixed(double value, int decimals, char *out) {
+    if (decimals < 0 || decimals > 9 || !isfinite(value)) {
+        return format_with_printf(value, decimals, out);
+    }
+    int negative = signbit(value) != 0;
+    double magnitude = negative ? -value : value;
+    // Das Produkt weicht höchstens eine halbe Einheit der letzten Stelle vom exakten Wert ab;
+    // unterhalb von FIXED_FAST_LIMIT sind das weniger als FIXED_TIE_WINDOW. Nur Werte nahe
+    // an .5 könnten daher anders runden als printf und gehen den langsamen Weg.
+    double scaled = magnitude * (double)POWERS_OF_TEN[decimals];
+    if (scaled >= FIXED_FAST_LIMIT) {
+        return format_with_printf(value, decimals, out);
+    }
+    unsigned long long whole = (unsigned long long)scaled;
+    double fraction = scaled - (double)whole;
+    double distance = fraction > 0.5 ? fraction - 0.5 : 0.5 - fraction;
+    if (distance < FIXED_TIE_WINDOW) {
+        return format_with_printf(value, decimals, out);
+    }
+    if (fraction > 0.5) {
+        whole++;
+    }
+    size_t len = 0;
+    if (negative) {
+        out[len++] = '-';
+    }
+    len += write_unsigned(whole / POWERS_OF_TEN[decimals], out + len);
+    if (decimals > 0) {
+        out[len++] = '.';
+        write_padded(whole % POWERS_OF_TEN[decimals], decimals, out + len);
+        len += (size_t)decimals;
+    }
+    return len;
+}
@@ -3,6 +3,8 @@
 #include "database/database_controller.h"
 #include "database/quantity_unit_utils.h"
 #include "database/text_input_utils.h"
+#include "webserver/api/api_db_cache.h"
+#include "webserver/web_trace.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -12,7 +14,7 @@ static void append_menge_json(Buffer *buf, const DatabaseEntry *entry) {
     buffer_append_str(buf, ",\"mengeWert\":");
     char mengen_text[32];
     formatiere_mengenwert(entry->menge_wert, mengen_text, sizeof mengen_text);
-    buffer_append_format(buf, "%s", mengen_text);
+    buffer_append_str(buf, mengen_text);
     buffer_append_str(buf, ",\"mengeEinheit\":");
     append_json_string(buf, entry->menge_einheit);
 }
@@ -33,10 +35,21 @@ static int parse_double_param(const char *value, double *out) {
     return 0;
 }
 
+// Texte werden einmal im Wörterbuch nachgeschlagen, die Schleifen laufen über die Spalten
 static int find_list_provider(const Database *db, const char *article, const char *provider) {
-    for (int i = 0; i < db->anzahl; i++) {
-        if (strcmp(db->eintraege[i].artikel, article) == 0) {
-            if (provider == NULL || provider[0] == '\0' || strcmp(db->eintraege[i].anbieter, provider) == 0) {
+    const DatabaseColumns *columns = database_cache_columns(db);
+    uint32_t article_id = datenbank_text_suchen(db, article);
+    if (article_id == DB_KEIN_TEXT) {
+        return -1;
+    }
+    int any_provider = provider == NULL || provider[0] == '\0';
+    uint32_t provider_id = any_provider ? DB_KEIN_TEXT : datenbank_text_suchen(db, provider);
+    if (!any_provider && provider_id == DB_KEIN_TEXT) {
+        return -1;
+    }
+    for (int i = 0; i < columns->count; i++) {
+        if (columns->article_id[i] == article_id) {
+            if (any_provider || columns->provider_id[i] == provider_id) {
                 return i;
             }
         }
@@ -44,7 +57,7 @@ static int find_list_provider(const Database *db, const char *article, const cha
     return -1;
 }
 
-void api_compare_handle_single(socket_t client, const HttpRequest *req) {
+void api_compare_handle_single(HttpClient *client, const HttpRequest *req) {
     const char *name = find_param(req->body_params, req->body_count, "name");
     const char *first_id_text = find_param(req->body_params, req->body_count, "firstId");
     const char *second_id_text = find_param(req->body_params, req->body_count, "secondId");
@@ -73,28 +86,41 @@ void api_compare_handle_single(socket_t client, const HttpRequest *req) {
         return;
     }
     char path[DB_MAX_FILENAME];
-    if (resolve_database_path(name, path, sizeof path) != 0) {
+    WEB_TRACE_ENTER(WEB_TRACE_RESOLVE_PATH);
+    int resolved = resolve_database_path(name, path, sizeof path);
+    WEB_TRACE_LEAVE();
+    if (resolved != 0) {
         send_error(client, "404 Not Found", "Datenbank nicht gefunden");
         return;
     }
-    Database db;
-    if (load_database(path, &db) != 0) {
+    WEB_TRACE_ENTER(WEB_TRACE_LOAD_DATABASE);
+    const Database *db = database_cache_acquire(path);
+    WEB_TRACE_LEAVE();
+    if (db == NULL) {
         send_error(client, "500 Internal Server Error", "Datenbank konnte nicht geladen werden");
         return;
     }
-    DatabaseEntry *first = find_entry_by_id(&db, first_id);
-    DatabaseEntry *second = find_entry_by_id(&db, second_id);
-    if (first == NULL || second == NULL) {
+    const DatabaseColumns *columns = database_cache_columns(db);
+    int first_index = database_columns_find_id(columns, first_id);
+    int second_index = database_columns_find_id(columns, second_id);
+    if (first_index < 0 || second_index < 0) {
+        database_cache_release(db);
         send_error(client, "404 Not Found", "Eintrag nicht gefunden");
         return;
     }
+    // Texte der Einträge liegen im Wörterbuch der Datenbank: die Referenz bleibt
+    // gehalten, bis die Antwort aufgebaut ist
+    const DatabaseEntry *first = &db->eintraege[first_index];
+    const DatabaseEntry *second = &db->eintraege[second_index];
     Quantity qty_first;
     Quantity qty_second;
     if (entry_to_quantity(first, &qty_first) != 0 || entry_to_quantity(second, &qty_second) != 0) {
+        database_cache_release(db);
         send_error(client, "400 Bad Request", "Mengenangaben können nicht interpretiert werden");
         return;
     }
     if (qty_first.type != qty_second.type) {
+        database_cache_release(db);
         send_error(client, "400 Bad Request", "Einheiten sind nicht kompatibel");
         return;
     }
@@ -112,63 +138,68 @@ void api_compare_handle_single(socket_t client, const HttpRequest *req) {
     }
     Buffer buf;
     if (buffer_init(&buf) != 0) {
+        database_cache_release(db);
         send_error(client, "500 Internal Server Error", "Speicherfehler");
         return;
     }
     buffer_append_str(&buf, "{\"status\":\"ok\",\"unit\":");
     append_json_string(&buf, unit);
     buffer_append_str(&buf, ",\"amount\":");
-    buffer_append_format(&buf, "%.4f", amount);
+    buffer_append_fixed(&buf, amount, 4);
     buffer_append_str(&buf, ",\"cheaper\":");
     append_json_string(&buf, cheaper);
     buffer_append_str(&buf, ",\"first\":{");
     buffer_append_str(&buf, "\"id\":");
-    buffer_append_format(&buf, "%d", first->id);
+    buffer_append_int(&buf, first->id);
     buffer_append_str(&buf, ",\"artikel\":");
-    append_json_string(&buf, first->artikel);
+    append_json_string(&buf, datenbank_text(db, first->artikel_id));
     buffer_append_str(&buf, ",\"anbieter\":");
-    append_json_string(&buf, first->anbieter);
+    append_json_string(&buf, datenbank_text(db, first->anbieter_id));
     append_menge_json(&buf, first);
     buffer_append_str(&buf, ",\"preisCent\":");
-    buffer_append_format(&buf, "%d", first->preis_ct);
+    buffer_append_int(&buf, first->preis_ct);
     buffer_append_str(&buf, ",\"unitPrice\":");
-    buffer_append_format(&buf, "%.6f", unit_price_first);
+    buffer_append_fixed(&buf, unit_price_first, 6);
     buffer_append_str(&buf, ",\"total\":");
-    buffer_append_format(&buf, "%.6f", total_first);
+    buffer_append_fixed(&buf, total_first, 6);
     buffer_append_str(&buf, "},\"second\":{");
     buffer_append_str(&buf, "\"id\":");
-    buffer_append_format(&buf, "%d", second->id);
+    buffer_append_int(&buf, second->id);
     buffer_append_str(&buf, ",\"artikel\":");
-    append_json_string(&buf, second->artikel);
+    append_json_string(&buf, datenbank_text(db, second->artikel_id));
     buffer_append_str(&buf, ",\"anbieter\":");
-    append_json_string(&buf, second->anbieter);
+    append_json_string(&buf, datenbank_text(db, second->anbieter_id));
     append_menge_json(&buf, second);
     buffer_append_str(&buf, ",\"preisCent\":");
-    buffer_append_format(&buf, "%d", second->preis_ct);
+    buffer_append_int(&buf, second->preis_ct);
     buffer_append_str(&buf, ",\"unitPrice\":");
-    buffer_append_format(&buf, "%.6f", unit_price_second);
+    buffer_append_fixed(&buf, unit_price_second, 6);
     buffer_append_str(&buf, ",\"total\":");
-    buffer_append_format(&buf, "%.6f", total_second);
+    buffer_append_fixed(&buf, total_second, 6);
     buffer_append_str(&buf, "}}");
     buffer_append_char(&buf, '}');
+    database_cache_release(db);
     send_json_response(client, "200 OK", buf.data, buf.len);
     buffer_free(&buf);
 }
 
 static int find_best_price(const Database *db, const char *article, const char *preferred_provider, int *best_index) {
+    const DatabaseColumns *columns = database_cache_columns(db);
+    uint32_t article_id = datenbank_text_suchen(db, article);
+    if (article_id == DB_KEIN_TEXT) {
+        return -1;
+    }
+    int has_preference = preferred_provider != NULL && preferred_provider[0] != '\0';
+    // Unbekannter Anbieter: DB_KEIN_TEXT passt auf keinen Eintrag
+    uint32_t preferred_id = has_preference ? datenbank_text_suchen(db, preferred_provider) : DB_KEIN_TEXT;
     double best_price = INFINITY;
     int found = 0;
-    for (int i = 0; i < db->anzahl; i++) {
-        if (strcmp(db->eintraege[i].artikel, article) != 0) {
-            continue;
-        }
-        Quantity qty;
-        if (entry_to_quantity(&db->eintraege[i], &qty) != 0 || qty.amount <= 0) {
+    for (int i = 0; i < columns->count; i++) {
+        if (columns->article_id[i] != article_id || columns->amount[i] <= 0.0) {
             continue;
         }
-        double unit_price = (double)db->eintraege[i].preis_ct / qty.amount;
-        if (preferred_provider != NULL && preferred_provider[0] != '\0' &&
-            strcmp(db->eintraege[i].anbieter, preferred_provider) != 0) {
+        double unit_price = (double)columns->price_ct[i] / columns->amount[i];
+        if (has_preference && columns->provider_id[i] != preferred_id) {
             if (!isfinite(best_price)) {
                 best_price = unit_price;
                 *best_index = i;
@@ -185,7 +216,7 @@ static int find_best_price(const Database *db, const char *article, const char *
     return found ? 0 : -1;
 }
 
-void api_compare_handle_list(socket_t client, const HttpRequest *req) {
+void api_compare_handle_list(HttpClient *client, const HttpRequest *req) {
     const char *name = find_param(req->body_params, req->body_count, "name");
     const char *apply_text = find_param(req->body_params, req->body_count, "apply");
     if (name == NULL) {
@@ -201,79 +232,101 @@ void api_compare_handle_list(socket_t client, const HttpRequest *req) {
         apply = 1;
     }
     char path[DB_MAX_FILENAME];
-    if (resolve_database_path(name, path, sizeof path) != 0) {
+    WEB_TRACE_ENTER(WEB_TRACE_RESOLVE_PATH);
+    int resolved = resolve_database_path(name, path, sizeof path);
+    WEB_TRACE_LEAVE();
+    if (resolved != 0) {
         send_error(client, "404 Not Found", "Datenbank nicht gefunden");
         return;
     }
-    Database db;
-    if (load_database(path, &db) != 0) {
+    WEB_TRACE_ENTER(WEB_TRACE_LOAD_DATABASE);
+    const Database *db = database_cache_acquire(path);
+    WEB_TRACE_LEAVE();
+    if (db == NULL) {
         send_error(client, "500 Internal Server Error", "Datenbank konnte nicht geladen werden");
         return;
     }
-    char items[SHOPPING_LIST_MAX_ITEMS][SHOPPING_LIST_MAX_LEN];
+    char (*items)[SHOPPING_LIST_MAX_LEN] = (char (*)[SHOPPING_LIST_MAX_LEN])request_alloc(
+        client, SHOPPING_LIST_MAX_ITEMS * sizeof *items);
+    if (items == NULL) {
+        database_cache_release(db);
+        return;
+    }
+    WEB_TRACE_ENTER(WEB_TRACE_LOAD_LIST);
     int count = load_shopping_list(items, SHOPPING_LIST_MAX_ITEMS);
-    Buffer buf;
-    if (buffer_init(&buf) != 0) {
+    WEB_TRACE_LEAVE();
+    ResponseStream stream;
+    if (response_stream_begin(&stream, client, "200 OK", "application/json; charset=utf-8") != 0) {
+        database_cache_release(db);
         send_error(client, "500 Internal Server Error", "Speicherfehler");
         return;
     }
     int changed = 0;
-    buffer_append_str(&buf, "{\"status\":\"ok\",\"items\":[");
+    WEB_TRACE_ENTER(WEB_TRACE_SERIALIZE);
+    buffer_append_str(&stream.body, "{\"status\":\"ok\",\"items\":[");
     for (int i = 0; i < count; i++) {
         if (i > 0) {
-            buffer_append_char(&buf, ',');
+            buffer_append_char(&stream.body, ',');
         }
         char article[DB_MAX_TEXT];
         char provider[DB_MAX_TEXT];
         split_list_entry(items[i], article, sizeof article, provider, sizeof provider);
-        buffer_append_str(&buf, "{\"text\":");
-        append_json_string(&buf, items[i]);
-        buffer_append_str(&buf, ",\"empfehlung\":null");
-        int idx = find_list_provider(&db, article, provider);
+        buffer_append_str(&stream.body, "{\"text\":");
+        append_json_string(&stream.body, items[i]);
+        buffer_append_str(&stream.body, ",\"empfehlung\":null");
+        WEB_TRACE_ENTER(WEB_TRACE_COMPARE);
+        int idx = find_list_provider(db, article, provider);
+        WEB_TRACE_LEAVE();
         if (idx >= 0) {
-            buffer_append_str(&buf, ",\"treffer\":{");
-            buffer_append_str(&buf, "\"anbieter\":");
-            append_json_string(&buf, db.eintraege[idx].anbieter);
-            append_menge_json(&buf, &db.eintraege[idx]);
-            buffer_append_str(&buf, ",\"preisCent\":");
-            buffer_append_format(&buf, "%d", db.eintraege[idx].preis_ct);
+            buffer_append_str(&stream.body, ",\"treffer\":{");
+            buffer_append_str(&stream.body, "\"anbieter\":");
+            append_json_string(&stream.body, datenbank_text(db, db->eintraege[idx].anbieter_id));
+            append_menge_json(&stream.body, &db->eintraege[idx]);
+            buffer_append_str(&stream.body, ",\"preisCent\":");
+            buffer_append_int(&stream.body, db->eintraege[idx].preis_ct);
             Quantity qty;
-            if (entry_to_quantity(&db.eintraege[idx], &qty) == 0 && qty.amount > 0.0) {
-                buffer_append_str(&buf, ",\"unitPrice\":");
-                buffer_append_format(&buf, "%.6f", (double)db.eintraege[idx].preis_ct / qty.amount);
-                buffer_append_str(&buf, ",\"unit\":");
-                append_json_string(&buf, unit_label(qty.type));
+            if (entry_to_quantity(&db->eintraege[idx], &qty) == 0 && qty.amount > 0.0) {
+                buffer_append_str(&stream.body, ",\"unitPrice\":");
+                buffer_append_fixed(&stream.body, (double)db->eintraege[idx].preis_ct / qty.amount, 6);
+                buffer_append_str(&stream.body, ",\"unit\":");
+                append_json_string(&stream.body, unit_label(qty.type));
             }
-            buffer_append_char(&buf, '}');
+            buffer_append_char(&stream.body, '}');
         }
         int best = -1;
-        if (find_best_price(&db, article, provider, &best) == 0) {
-            DatabaseEntry *best_entry = &db.eintraege[best];
-            buffer_append_str(&buf, ",\"empfehlung\":{");
-            buffer_append_str(&buf, "\"anbieter\":");
-            append_json_string(&buf, best_entry->anbieter);
-            append_menge_json(&buf, best_entry);
-            buffer_append_str(&buf, ",\"preisCent\":");
-            buffer_append_format(&buf, "%d", best_entry->preis_ct);
+        WEB_TRACE_ENTER(WEB_TRACE_COMPARE);
+        int found = find_best_price(db, article, provider, &best);
+        WEB_TRACE_LEAVE();
+        if (found == 0) {
+            const DatabaseEntry *best_entry = &db->eintraege[best];
+            buffer_append_str(&stream.body, ",\"empfehlung\":{");
+            buffer_append_str(&stream.body, "\"anbieter\":");
+            append_json_string(&stream.body, datenbank_text(db, best_entry->anbieter_id));
+            append_menge_json(&stream.body, best_entry);
+            buffer_append_str(&stream.body, ",\"preisCent\":");
+            buffer_append_int(&stream.body, best_entry->preis_ct);
             Quantity best_qty;
             if (entry_to_quantity(best_entry, &best_qty) == 0 && best_qty.amount > 0.0) {
-                buffer_append_str(&buf, ",\"unitPrice\":");
-                buffer_append_format(&buf, "%.6f", (double)best_entry->preis_ct / best_qty.amount);
-                buffer_append_str(&buf, ",\"unit\":");
-                append_json_string(&buf, unit_label(best_qty.type));
+                buffer_append_str(&stream.body, ",\"unitPrice\":");
+                buffer_append_fixed(&stream.body, (double)best_entry->preis_ct / best_qty.amount, 6);
+                buffer_append_str(&stream.body, ",\"unit\":");
+                append_json_string(&stream.body, unit_label(best_qty.type));
             }
-            buffer_append_char(&buf, '}');
-            if (apply != 0 && strcmp(provider, best_entry->anbieter) != 0) {
+            buffer_append_char(&stream.body, '}');
+            const char *best_provider = datenbank_text(db, best_entry->anbieter_id);
+            if (apply != 0 && strcmp(provider, best_provider) != 0) {
                 changed = 1;
-                build_list_entry(best_entry->artikel, best_entry->anbieter, items[i], sizeof items[i]);
+                build_list_entry(datenbank_text(db, best_entry->artikel_id), best_provider, items[i], sizeof items[i]);
             }
         }
-        buffer_append_char(&buf, '}');
+        buffer_append_char(&stream.body, '}');
+        response_stream_flush(&stream);
     }
-    buffer_append_str(&buf, "]}");
+    buffer_append_str(&stream.body, "]}");
+    WEB_TRACE_LEAVE();
+    database_cache_release(db);
     if (apply != 0 && changed != 0) {
         save_shopping_list(items, count);
     }
-    send_json_response(client, "200 OK", buf.data, buf.len);
-    buffer_free(&buf);
+    response_stream_end(&stream);
 }
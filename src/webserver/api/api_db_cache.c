@@ -0,0 +1,178 @@
+#include "webserver/api/api_db_cache.h"
+
+#include "database/database_controller.h"
+#include "webserver/web_core.h"
+#include "webserver/web_thread.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define DATABASE_CACHE_MAX_ENTRIES 16
+
+typedef struct {
+    Database db;               // Erstes Feld: aus einem Database-Zeiger wird so der Eintrag
+    DatabaseColumns columns;   // Spaltenansicht von db, wird mit jedem Stand neu aufgebaut
+    char path[DB_MAX_FILENAME];
+    long long mtime_ns;
+    long long size;
+    web_counter_t last_used;
+    web_refcount_t refcount;   // Eine Referenz hält der Cache selbst, solange der Eintrag drin ist
+} CachedDatabase;
+
+// Treffer laufen unter der Lesesperre; einfügen und verdrängen unter der Schreibsperre
+static CachedDatabase *g_entries[DATABASE_CACHE_MAX_ENTRIES];
+static size_t g_count;
+static web_counter_t g_use_clock;
+static web_rwlock_t g_cache_lock = WEB_RWLOCK_INIT;
+
+static CachedDatabase *entry_of(const Database *db) {
+    return (CachedDatabase *)((char *)db - offsetof(CachedDatabase, db));
+}
+
+static int find_entry(const char *path) {
+    for (size_t i = 0; i < g_count; i++) {
+        if (strcmp(g_entries[i]->path, path) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void free_entry(CachedDatabase *entry) {
+    database_columns_free(&entry->columns);
+    free_database(&entry->db);
+    free(entry);
+}
+
+// Nimmt den Eintrag aus dem Cache; wer ihn noch hält, gibt ihn beim release frei
+static void drop_locked(size_t index) {
+    CachedDatabase *entry = g_entries[index];
+    g_entries[index] = g_entries[--g_count];
+    if (web_refcount_drop(&entry->refcount)) {
+        free_entry(entry);
+    }
+}
+
+// Platz für einen neuen Eintrag; verdrängt den am längsten unbenutzten, der gerade frei ist
+static int make_room_locked(void) {
+    if (g_count < DATABASE_CACHE_MAX_ENTRIES) {
+        return 0;
+    }
+    int victim = -1;
+    for (size_t i = 0; i < g_count; i++) {
+        // Unter der Schreibsperre kommt keine Referenz hinzu; 1 ist die des Caches
+        if (web_refcount_get(&g_entries[i]->refcount) == 1 &&
+            (victim < 0 || web_counter_load(&g_entries[i]->last_used) <
+                               web_counter_load(&g_entries[victim]->last_used))) {
+            victim = (int)i;
+        }
+    }
+    if (victim < 0) {
+        return -1;
+    }
+    drop_locked((size_t)victim);
+    return 0;
+}
+
+static Database *acquire(const char *path) {
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode) || strlen(path) >= DB_MAX_FILENAME) {
+        return NULL;
+    }
+    web_rwlock_read_lock(&g_cache_lock);
+    int index = find_entry(path);
+    if (index >= 0) {
+        CachedDatabase *cached = g_entries[index];
+        if (cached->mtime_ns == file_mtime_ns(&info) && cached->size == (long long)info.st_size) {
+            web_refcount_retain(&cached->refcount);
+            web_counter_store(&cached->last_used, web_counter_next(&g_use_clock));
+            web_rwlock_read_unlock(&g_cache_lock);
+            return &cached->db;
+        }
+    }
+    web_rwlock_read_unlock(&g_cache_lock);
+
+    // CSV außerhalb der Sperre parsen; ändert sich die Datei währenddessen, passt der
+    // vorher gemessene Stand nicht mehr und der nächste Zugriff lädt erneut
+    CachedDatabase *fresh = (CachedDatabase *)malloc(sizeof *fresh);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    if (load_database(path, &fresh->db) != 0) {
+        free(fresh);
+        return NULL;
+    }
+    database_columns_init(&fresh->columns);
+    if (database_columns_build(&fresh->columns, &fresh->db) != 0) {
+        free_entry(fresh);
+        return NULL;
+    }
+    strcpy(fresh->path, path);
+    fresh->mtime_ns = file_mtime_ns(&info);
+    fresh->size = (long long)info.st_size;
+    web_refcount_set(&fresh->refcount, 1);
+    web_counter_store(&fresh->last_used, web_counter_next(&g_use_clock));
+
+    web_rwlock_write_lock(&g_cache_lock);
+    index = find_entry(path);
+    if (index >= 0) {
+        drop_locked((size_t)index);
+    }
+    // Sind alle Plätze in Benutzung, bleibt es bei der Referenz dieses Aufrufers
+    if (make_room_locked() == 0) {
+        web_refcount_retain(&fresh->refcount);
+        g_entries[g_count++] = fresh;
+    }
+    web_rwlock_write_unlock(&g_cache_lock);
+    return &fresh->db;
+}
+
+const Database *database_cache_acquire(const char *path) {
+    return acquire(path);
+}
+
+Database *database_cache_acquire_for_update(const char *path) {
+    return acquire(path);
+}
+
+const DatabaseColumns *database_cache_columns(const Database *db) {
+    return &entry_of(db)->columns;
+}
+
+void database_cache_release(const Database *db) {
+    if (db == NULL) {
+        return;
+    }
+    CachedDatabase *entry = entry_of(db);
+    if (web_refcount_drop(&entry->refcount)) {
+        free_entry(entry);
+    }
+}
+
+int database_cache_commit(Database *db) {
+    CachedDatabase *entry = entry_of(db);
+    int result = save_database(db);
+    struct stat info;
+    if (result == 0 && stat(entry->path, &info) != 0) {
+        result = -1;
+    }
+    // Kein Leser hält die Datenbank (Schreibsperre), die Spalten dürfen ersetzt werden
+    int columns_ok = result == 0 && database_columns_build(&entry->columns, db) == 0;
+    web_rwlock_write_lock(&g_cache_lock);
+    if (columns_ok) {
+        entry->mtime_ns = file_mtime_ns(&info);
+        entry->size = (long long)info.st_size;
+    } else {
+        // Speicher, Spalten und Datei stimmen nicht mehr überein: beim nächsten Zugriff neu laden
+        // Der Aufrufer hält noch eine Referenz, freigegeben wird erst beim release
+        int index = find_entry(entry->path);
+        if (index >= 0 && g_entries[index] == entry) {
+            drop_locked((size_t)index);
+        }
+    }
+    web_rwlock_write_unlock(&g_cache_lock);
+    return result;
+}
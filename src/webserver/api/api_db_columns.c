@@ -0,0 +1,64 @@
+#include "webserver/api/api_db_columns.h"
+
+#include <stdlib.h>
+
+void database_columns_init(DatabaseColumns *columns) {
+    columns->ids = NULL;
+    columns->price_ct = NULL;
+    columns->amount = NULL;
+    columns->unit = NULL;
+    columns->article_id = NULL;
+    columns->provider_id = NULL;
+    columns->count = 0;
+    columns->block = NULL;
+}
+
+int database_columns_build(DatabaseColumns *columns, const Database *db) {
+    size_t count = db->anzahl > 0 ? (size_t)db->anzahl : 0;
+    // Reihenfolge nach Ausrichtung: erst double, dann 4-Byte-Spalten, zuletzt Bytes
+    size_t size = count * (sizeof(double) + 2 * sizeof(int) + 2 * sizeof(uint32_t) + 1);
+    char *block = (char *)malloc(size > 0 ? size : 1);
+    if (block == NULL) {
+        return -1;
+    }
+    DatabaseColumns fresh;
+    fresh.amount = (double *)block;
+    fresh.ids = (int *)(fresh.amount + count);
+    fresh.price_ct = fresh.ids + count;
+    fresh.article_id = (uint32_t *)(fresh.price_ct + count);
+    fresh.provider_id = fresh.article_id + count;
+    fresh.unit = (unsigned char *)(fresh.provider_id + count);
+    fresh.count = (int)count;
+    fresh.block = block;
+    for (size_t i = 0; i < count; i++) {
+        const DatabaseEntry *entry = &db->eintraege[i];
+        Quantity qty;
+        if (entry_to_quantity(entry, &qty) != 0) {
+            qty.amount = 0.0;
+            qty.type = UNIT_UNKNOWN;
+        }
+        fresh.ids[i] = entry->id;
+        fresh.price_ct[i] = entry->preis_ct;
+        fresh.amount[i] = qty.amount;
+        fresh.unit[i] = (unsigned char)qty.type;
+        fresh.article_id[i] = entry->artikel_id;
+        fresh.provider_id[i] = entry->anbieter_id;
+    }
+    database_columns_free(columns);
+    *columns = fresh;
+    return 0;
+}
+
+void database_columns_free(DatabaseColumns *columns) {
+    free(columns->block);
+    database_columns_init(columns);
+}
+
+int database_columns_find_id(const DatabaseColumns *columns, int id) {
+    for (int i = 0; i < columns->count; i++) {
+        if (columns->ids[i] == id) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -3,6 +3,7 @@
 #include "database/database_controller.h"
 #include "database/quantity_unit_utils.h"
 #include "database/text_input_utils.h"
+#include "webserver/api/api_db_cache.h"
 
 #include <limits.h>
 #include <stdlib.h>
@@ -35,13 +36,16 @@ static void append_menge_json(Buffer *buf, const DatabaseEntry *entry) {
     buffer_append_str(buf, ",\"mengeWert\":");
     char mengen_text[32];
     formatiere_mengenwert(entry->menge_wert, mengen_text, sizeof mengen_text);
-    buffer_append_format(buf, "%s", mengen_text);
+    buffer_append_str(buf, mengen_text);
     buffer_append_str(buf, ",\"mengeEinheit\":");
     append_json_string(buf, entry->menge_einheit);
 }
 
-void api_db_handle_files(socket_t client) {
-    char files[MAX_DB_FILES][DB_MAX_FILENAME];
+void api_db_handle_files(HttpClient *client) {
+    char (*files)[DB_MAX_FILENAME] = (char (*)[DB_MAX_FILENAME])request_alloc(client, MAX_DB_FILES * sizeof *files);
+    if (files == NULL) {
+        return;
+    }
     int count = list_csv_files(DATA_DIRECTORY, files, MAX_DB_FILES);
     Buffer buf;
     if (buffer_init(&buf) != 0) {
@@ -62,7 +66,7 @@ void api_db_handle_files(socket_t client) {
     buffer_free(&buf);
 }
 
-void api_db_handle_get(socket_t client, const HttpRequest *req) {
+void api_db_handle_get(HttpClient *client, const HttpRequest *req) {
     const char *name = find_param(req->query_params, req->query_count, "name");
     if (name == NULL || *name == '\0') {
         send_error(client, "400 Bad Request", "Parameter 'name' fehlt");
@@ -77,43 +81,45 @@ void api_db_handle_get(socket_t client, const HttpRequest *req) {
         send_error(client, "404 Not Found", "Datenbank nicht gefunden");
         return;
     }
-    Database db;
-    if (load_database(path, &db) != 0) {
+    const Database *db = database_cache_acquire(path);
+    if (db == NULL) {
         send_error(client, "500 Internal Server Error", "Datenbank konnte nicht geladen werden");
         return;
     }
-    Buffer buf;
-    if (buffer_init(&buf) != 0) {
+    ResponseStream stream;
+    if (response_stream_begin(&stream, client, "200 OK", "application/json; charset=utf-8") != 0) {
+        database_cache_release(db);
         send_error(client, "500 Internal Server Error", "Speicherfehler");
         return;
     }
-    buffer_append_str(&buf, "{\"name\":");
-    append_json_string(&buf, name);
-    buffer_append_str(&buf, ",\"entries\":[");
-    for (int i = 0; i < db.anzahl; i++) {
+    buffer_append_str(&stream.body, "{\"name\":");
+    append_json_string(&stream.body, name);
+    buffer_append_str(&stream.body, ",\"entries\":[");
+    for (int i = 0; i < db->anzahl; i++) {
         if (i > 0) {
-            buffer_append_char(&buf, ',');
+            buffer_append_char(&stream.body, ',');
         }
-        DatabaseEntry *entry = &db.eintraege[i];
-        buffer_append_str(&buf, "{\"id\":");
-        buffer_append_format(&buf, "%d", entry->id);
-        buffer_append_str(&buf, ",\"artikel\":");
-        append_json_string(&buf, entry->artikel);
-        buffer_append_str(&buf, ",\"anbieter\":");
-        append_json_string(&buf, entry->anbieter);
-        buffer_append_str(&buf, ",\"preisCent\":");
-        buffer_append_format(&buf, "%d", entry->preis_ct);
-        buffer_append_str(&buf, ",\"preisEuro\":");
-        buffer_append_format(&buf, "%.2f", entry->preis_ct / 100.0);
-        append_menge_json(&buf, entry);
-        buffer_append_char(&buf, '}');
+        const DatabaseEntry *entry = &db->eintraege[i];
+        buffer_append_str(&stream.body, "{\"id\":");
+        buffer_append_int(&stream.body, entry->id);
+        buffer_append_str(&stream.body, ",\"artikel\":");
+        append_json_string(&stream.body, datenbank_text(db, entry->artikel_id));
+        buffer_append_str(&stream.body, ",\"anbieter\":");
+        append_json_string(&stream.body, datenbank_text(db, entry->anbieter_id));
+        buffer_append_str(&stream.body, ",\"preisCent\":");
+        buffer_append_int(&stream.body, entry->preis_ct);
+        buffer_append_str(&stream.body, ",\"preisEuro\":");
+        buffer_append_cents(&stream.body, entry->preis_ct);
+        append_menge_json(&stream.body, entry);
+        buffer_append_char(&stream.body, '}');
+        response_stream_flush(&stream);
     }
-    buffer_append_str(&buf, "]}");
-    send_json_response(client, "200 OK", buf.data, buf.len);
-    buffer_free(&buf);
+    buffer_append_str(&stream.body, "]}");
+    response_stream_end(&stream);
+    database_cache_release(db);
 }
 
-static void handle_db_add_or_update(socket_t client, const HttpRequest *req, int is_update) {
+static void handle_db_add_or_update(HttpClient *client, const HttpRequest *req, int is_update) {
     const char *name = find_param(req->body_params, req->body_count, "name");
     const char *artikel = find_param(req->body_params, req->body_count, "artikel");
     const char *anbieter = find_param(req->body_params, req->body_count, "anbieter");
@@ -148,63 +154,78 @@ static void handle_db_add_or_update(socket_t client, const HttpRequest *req, int
 
     int preis_cent = atoi(preis_text);
     double menge_wert = atof(menge_wert_text);
+    int id = 0;
+    if (is_update && (parse_int_param(id_text, &id) != 0 || id < 0)) {
+        send_error(client, "400 Bad Request", "Ungültige ID");
+        return;
+    }
 
     char path[DB_MAX_FILENAME];
     if (resolve_database_path(name, path, sizeof path) != 0) {
         send_error(client, "404 Not Found", "Datenbank nicht gefunden");
         return;
     }
-    Database db;
-    if (load_database(path, &db) != 0) {
+    // Läuft unter der Schreibsperre: die gecachte Datenbank wird direkt geändert
+    Database *db = database_cache_acquire_for_update(path);
+    if (db == NULL) {
         send_error(client, "500 Internal Server Error", "Datenbank konnte nicht geladen werden");
         return;
     }
 
     DatabaseEntry *entry = NULL;
     if (is_update) {
-        int id = 0;
-        if (parse_int_param(id_text, &id) != 0 || id < 0) {
-            send_error(client, "400 Bad Request", "Ungültige ID");
-            return;
-        }
-        entry = find_entry_by_id(&db, id);
+        entry = find_entry_by_id(db, id);
         if (entry == NULL) {
+            database_cache_release(db);
             send_error(client, "404 Not Found", "Eintrag nicht gefunden");
             return;
         }
+    }
+    uint32_t artikel_id = 0;
+    uint32_t anbieter_id = 0;
+    if (datenbank_text_internieren(db, artikel, &artikel_id) != 0 ||
+        datenbank_text_internieren(db, anbieter, &anbieter_id) != 0) {
+        database_cache_release(db);
+        send_error(client, "500 Internal Server Error", "Speicherfehler");
+        return;
+    }
+    if (is_update) {
         entry->id = id;
     } else {
-        entry = &db.eintraege[db.anzahl];
-        entry->id = next_entry_id(&db);
+        int new_id = next_entry_id(db);
+        entry = datenbank_neuer_eintrag(db);
+        if (entry == NULL) {
+            database_cache_release(db);
+            send_error(client, "500 Internal Server Error", "Speicherfehler");
+            return;
+        }
+        entry->id = new_id;
     }
-    strncpy(entry->artikel, artikel, DB_MAX_TEXT - 1);
-    entry->artikel[DB_MAX_TEXT - 1] = '\0';
-    strncpy(entry->anbieter, anbieter, DB_MAX_TEXT - 1);
-    entry->anbieter[DB_MAX_TEXT - 1] = '\0';
+    entry->artikel_id = artikel_id;
+    entry->anbieter_id = anbieter_id;
     entry->preis_ct = preis_cent;
     entry->menge_wert = menge_wert;
     strncpy(entry->menge_einheit, menge_einheit, sizeof entry->menge_einheit - 1);
     entry->menge_einheit[sizeof entry->menge_einheit - 1] = '\0';
 
-    if (!is_update) {
-        db.anzahl++;
-    }
-    if (save_database(&db) != 0) {
+    int saved = database_cache_commit(db);
+    database_cache_release(db);
+    if (saved != 0) {
         send_error(client, "500 Internal Server Error", "Speichern fehlgeschlagen");
         return;
     }
     send_json_string(client, "200 OK", "{\"status\":\"ok\"}");
 }
 
-void api_db_handle_add(socket_t client, const HttpRequest *req) {
+void api_db_handle_add(HttpClient *client, const HttpRequest *req) {
     handle_db_add_or_update(client, req, 0);
 }
 
-void api_db_handle_update(socket_t client, const HttpRequest *req) {
+void api_db_handle_update(HttpClient *client, const HttpRequest *req) {
     handle_db_add_or_update(client, req, 1);
 }
 
-void api_db_handle_delete(socket_t client, const HttpRequest *req) {
+void api_db_handle_delete(HttpClient *client, const HttpRequest *req) {
     const char *name = find_param(req->body_params, req->body_count, "name");
     const char *id_text = find_param(req->body_params, req->body_count, "id");
     if (name == NULL || id_text == NULL) {
@@ -225,21 +246,24 @@ void api_db_handle_delete(socket_t client, const HttpRequest *req) {
         send_error(client, "404 Not Found", "Datenbank nicht gefunden");
         return;
     }
-    Database db;
-    if (load_database(path, &db) != 0) {
+    Database *db = database_cache_acquire_for_update(path);
+    if (db == NULL) {
         send_error(client, "500 Internal Server Error", "Datenbank konnte nicht geladen werden");
         return;
     }
-    int index = find_entry_index(&db, id);
+    int index = find_entry_index(db, id);
     if (index < 0) {
+        database_cache_release(db);
         send_error(client, "404 Not Found", "Eintrag nicht gefunden");
         return;
     }
-    for (int i = index + 1; i < db.anzahl; i++) {
-        db.eintraege[i - 1] = db.eintraege[i];
+    for (int i = index + 1; i < db->anzahl; i++) {
+        db->eintraege[i - 1] = db->eintraege[i];
     }
-    db.anzahl--;
-    if (save_database(&db) != 0) {
+    db->anzahl--;
+    int saved = database_cache_commit(db);
+    database_cache_release(db);
+    if (saved != 0) {
         send_error(client, "500 Internal Server Error", "Speichern fehlgeschlagen");
         return;
     }
@@ -4,8 +4,12 @@
 
 #include <string.h>
 
-void api_list_handle_get(socket_t client) {
-    char items[SHOPPING_LIST_MAX_ITEMS][SHOPPING_LIST_MAX_LEN];
+void api_list_handle_get(HttpClient *client) {
+    char (*items)[SHOPPING_LIST_MAX_LEN] = (char (*)[SHOPPING_LIST_MAX_LEN])request_alloc(
+        client, SHOPPING_LIST_MAX_ITEMS * sizeof *items);
+    if (items == NULL) {
+        return;
+    }
     int count = load_shopping_list(items, SHOPPING_LIST_MAX_ITEMS);
     Buffer buf;
     if (buffer_init(&buf) != 0) {
@@ -21,7 +25,7 @@ void api_list_handle_get(socket_t client) {
         char provider[DB_MAX_TEXT];
         split_list_entry(items[i], article, sizeof article, provider, sizeof provider);
         buffer_append_str(&buf, "{\"index\":");
-        buffer_append_format(&buf, "%d", i);
+        buffer_append_int(&buf, i);
         buffer_append_str(&buf, ",\"artikel\":");
         append_json_string(&buf, article);
         buffer_append_str(&buf, ",\"anbieter\":");
@@ -35,8 +39,12 @@ void api_list_handle_get(socket_t client) {
     buffer_free(&buf);
 }
 
-void api_list_handle_download(socket_t client) {
-    char items[SHOPPING_LIST_MAX_ITEMS][SHOPPING_LIST_MAX_LEN];
+void api_list_handle_download(HttpClient *client) {
+    char (*items)[SHOPPING_LIST_MAX_LEN] = (char (*)[SHOPPING_LIST_MAX_LEN])request_alloc(
+        client, SHOPPING_LIST_MAX_ITEMS * sizeof *items);
+    if (items == NULL) {
+        return;
+    }
     int count = load_shopping_list(items, SHOPPING_LIST_MAX_ITEMS);
     Buffer buf;
     if (buffer_init(&buf) != 0) {
@@ -55,7 +63,7 @@ void api_list_handle_download(socket_t client) {
     buffer_free(&buf);
 }
 
-static void handle_list_add_or_update(socket_t client, const HttpRequest *req, int is_update) {
+static void handle_list_add_or_update(HttpClient *client, const HttpRequest *req, int is_update) {
     const char *artikel = find_param(req->body_params, req->body_count, "artikel");
     const char *anbieter = find_param(req->body_params, req->body_count, "anbieter");
     const char *index_text = find_param(req->body_params, req->body_count, "index");
@@ -71,7 +79,11 @@ static void handle_list_add_or_update(socket_t client, const HttpRequest *req, i
         send_error(client, "400 Bad Request", "Ungültiger Anbietertext");
         return;
     }
-    char items[SHOPPING_LIST_MAX_ITEMS][SHOPPING_LIST_MAX_LEN];
+    char (*items)[SHOPPING_LIST_MAX_LEN] = (char (*)[SHOPPING_LIST_MAX_LEN])request_alloc(
+        client, SHOPPING_LIST_MAX_ITEMS * sizeof *items);
+    if (items == NULL) {
+        return;
+    }
     int count = load_shopping_list(items, SHOPPING_LIST_MAX_ITEMS);
     if (is_update) {
         if (index_text == NULL) {
@@ -99,15 +111,15 @@ static void handle_list_add_or_update(socket_t client, const HttpRequest *req, i
     send_json_string(client, "200 OK", "{\"status\":\"ok\"}");
 }
 
-void api_list_handle_add(socket_t client, const HttpRequest *req) {
+void api_list_handle_add(HttpClient *client, const HttpRequest *req) {
     handle_list_add_or_update(client, req, 0);
 }
 
-void api_list_handle_update(socket_t client, const HttpRequest *req) {
+void api_list_handle_update(HttpClient *client, const HttpRequest *req) {
     handle_list_add_or_update(client, req, 1);
 }
 
-void api_list_handle_delete(socket_t client, const HttpRequest *req) {
+void api_list_handle_delete(HttpClient *client, const HttpRequest *req) {
     const char *index_text = find_param(req->body_params, req->body_count, "index");
     if (index_text == NULL) {
         send_error(client, "400 Bad Request", "Index fehlt");
@@ -118,7 +130,11 @@ void api_list_handle_delete(socket_t client, const HttpRequest *req) {
         send_error(client, "400 Bad Request", "Ungültiger Index");
         return;
     }
-    char items[SHOPPING_LIST_MAX_ITEMS][SHOPPING_LIST_MAX_LEN];
+    char (*items)[SHOPPING_LIST_MAX_LEN] = (char (*)[SHOPPING_LIST_MAX_LEN])request_alloc(
+        client, SHOPPING_LIST_MAX_ITEMS * sizeof *items);
+    if (items == NULL) {
+        return;
+    }
     int count = load_shopping_list(items, SHOPPING_LIST_MAX_ITEMS);
     if (index < 0 || index >= count) {
         send_error(client, "404 Not Found", "Eintrag nicht gefunden");
@@ -2,6 +2,7 @@
 
 #include "database/database_controller.h"
 #include "database/text_input_utils.h"
+#include "webserver/web_thread.h"
 
 #include <ctype.h>
 #include <errno.h>
@@ -12,6 +13,8 @@
 
 #define MAX_DB_FILES 128
 
+static web_rwlock_t g_data_lock = WEB_RWLOCK_INIT;
+
 static const char *basename_of(const char *path) {
     const char *slash = strrchr(path, '/');
 #ifdef _WIN32
@@ -222,6 +225,14 @@ DatabaseEntry *find_entry_by_id(Database *db, int id) {
     return NULL;
 }
 
+void *request_alloc(HttpClient *client, size_t size) {
+    void *memory = web_arena_alloc(client->arena, size);
+    if (memory == NULL) {
+        send_error(client, "500 Internal Server Error", "Speicherfehler");
+    }
+    return memory;
+}
+
 int find_entry_index(const Database *db, int id) {
     if (db == NULL) {
         return -1;
@@ -233,3 +244,19 @@ int find_entry_index(const Database *db, int id) {
     }
     return -1;
 }
+
+void api_data_lock_read(void) {
+    web_rwlock_read_lock(&g_data_lock);
+}
+
+void api_data_unlock_read(void) {
+    web_rwlock_read_unlock(&g_data_lock);
+}
+
+void api_data_lock_write(void) {
+    web_rwlock_write_lock(&g_data_lock);
+}
+
+void api_data_unlock_write(void) {
+    web_rwlock_write_unlock(&g_data_lock);
+}
@@ -3,51 +3,155 @@
 #include "webserver/api/api_compare_handlers.h"
 #include "webserver/api/api_db_handlers.h"
 #include "webserver/api/api_list_handlers.h"
+#include "webserver/web_metrics.h"
+#include "webserver/web_router.h"
 
-void handle_db_files(socket_t client) {
+#include <string.h>
+
+// Handler laufen unter der Datensperre, ihre Antwort wird aber erst nach dem Entsperren
+// gesendet: ein langsamer Client hält so keine anderen API-Anfragen auf
+typedef struct {
+    Buffer held;
+    int write;
+} DataSection;
+
+static void data_section_enter(DataSection *section, HttpClient *client, int write) {
+    section->write = write;
+    http_client_hold_output(client, &section->held);
+    if (write) {
+        api_data_lock_write();
+    } else {
+        api_data_lock_read();
+    }
+}
+
+static void data_section_leave(DataSection *section, HttpClient *client) {
+    if (section->write) {
+        api_data_unlock_write();
+    } else {
+        api_data_unlock_read();
+    }
+    http_client_release_output(client, &section->held);
+}
+
+static void handle_db_files(HttpClient *client, const HttpRequest *req) {
+    (void)req;
     api_db_handle_files(client);
 }
 
-void handle_db_get(socket_t client, const HttpRequest *req) {
+static void handle_db_get(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 0);
     api_db_handle_get(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_db_add(socket_t client, const HttpRequest *req) {
+static void handle_db_add(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_db_handle_add(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_db_update(socket_t client, const HttpRequest *req) {
+static void handle_db_update(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_db_handle_update(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_db_delete(socket_t client, const HttpRequest *req) {
+static void handle_db_delete(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_db_handle_delete(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_list_get(socket_t client) {
+static void handle_list_get(HttpClient *client, const HttpRequest *req) {
+    (void)req;
+    DataSection section;
+    data_section_enter(&section, client, 0);
     api_list_handle_get(client);
+    data_section_leave(&section, client);
 }
 
-void handle_list_add(socket_t client, const HttpRequest *req) {
+static void handle_list_add(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_list_handle_add(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_list_update(socket_t client, const HttpRequest *req) {
+static void handle_list_update(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_list_handle_update(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_list_delete(socket_t client, const HttpRequest *req) {
+static void handle_list_delete(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 1);
     api_list_handle_delete(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_list_download(socket_t client) {
+static void handle_list_download(HttpClient *client, const HttpRequest *req) {
+    (void)req;
+    DataSection section;
+    data_section_enter(&section, client, 0);
     api_list_handle_download(client);
+    data_section_leave(&section, client);
 }
 
-void handle_compare_single(socket_t client, const HttpRequest *req) {
+static void handle_compare_single(HttpClient *client, const HttpRequest *req) {
+    DataSection section;
+    data_section_enter(&section, client, 0);
     api_compare_handle_single(client, req);
+    data_section_leave(&section, client);
 }
 
-void handle_compare_list(socket_t client, const HttpRequest *req) {
+static void handle_compare_list(HttpClient *client, const HttpRequest *req) {
+    const char *apply = find_param(req->body_params, req->body_count, "apply");
+    DataSection section;
+    data_section_enter(&section, client, apply != NULL && strcmp(apply, "1") == 0);
     api_compare_handle_list(client, req);
+    data_section_leave(&section, client);
+}
+
+// Prometheus-Textformat; liest nur die Zähler der Threads und braucht keine Datensperre
+static void handle_metrics(HttpClient *client, const HttpRequest *req) {
+    (void)req;
+    Buffer buf;
+    if (buffer_init(&buf) != 0) {
+        send_error(client, "500 Internal Server Error", "Speicherfehler");
+        return;
+    }
+    if (web_metrics_write_prometheus(&buf) != 0) {
+        buffer_free(&buf);
+        send_error(client, "500 Internal Server Error", "Speicherfehler");
+        return;
+    }
+    send_response(client, "200 OK", "text/plain; version=0.0.4; charset=utf-8", buf.data, buf.len);
+    buffer_free(&buf);
+}
+
+static const WebRoute API_ROUTES[] = {
+    { "/api/db-files",       ROUTE_GET,  0, handle_db_files },
+    { "/api/db",             ROUTE_GET,  0, handle_db_get },
+    { "/api/db/add",         ROUTE_POST, 0, handle_db_add },
+    { "/api/db/update",      ROUTE_POST, 0, handle_db_update },
+    { "/api/db/delete",      ROUTE_POST, 0, handle_db_delete },
+    { "/api/list",           ROUTE_GET,  0, handle_list_get },
+    { "/api/list/add",       ROUTE_POST, 0, handle_list_add },
+    { "/api/list/update",    ROUTE_POST, 0, handle_list_update },
+    { "/api/list/delete",    ROUTE_POST, 0, handle_list_delete },
+    { "/api/list/download",  ROUTE_GET,  0, handle_list_download },
+    { "/api/compare/single", ROUTE_POST, 0, handle_compare_single },
+    { "/api/compare/list",   ROUTE_POST, 0, handle_compare_list },
+    { "/api/metrics",        ROUTE_GET,  0, handle_metrics },
+};
+
+int web_api_register_routes(void) {
+    return web_router_register(API_ROUTES, sizeof API_ROUTES / sizeof API_ROUTES[0]);
 }
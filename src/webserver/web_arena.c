@@ -0,0 +1,125 @@
+#include "webserver/web_arena.h"
+
+#include "webserver/web_thread.h"
+
+#include <stdlib.h>
+
+#define ARENA_ALIGNMENT 16u
+#define POOL_CLASS_COUNT 9          // 1 KB ... 256 KB
+#define POOL_CLASS_RETAINED 32      // Höchstens so viele freie Blöcke je Klasse und Thread
+
+struct WebArenaBlock {
+    WebArenaBlock *prev;
+    size_t size;
+    size_t used;
+};
+
+// Kopf auf die Ausrichtung aufgerundet, damit die Nutzdaten ausgerichtet beginnen
+#define BLOCK_HEADER ((sizeof(WebArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+static unsigned char *block_data(WebArenaBlock *block) {
+    return (unsigned char *)block + BLOCK_HEADER;
+}
+
+void *web_arena_alloc(WebArena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    WebArenaBlock *block = arena->current;
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = arena->next_block > WEB_ARENA_BLOCK_SIZE ? arena->next_block : WEB_ARENA_BLOCK_SIZE;
+        if (block_size < size) {
+            block_size = size;
+        }
+        WebArenaBlock *fresh = (WebArenaBlock *)malloc(BLOCK_HEADER + block_size);
+        if (fresh == NULL) {
+            return NULL;
+        }
+        fresh->prev = block;
+        fresh->size = block_size;
+        fresh->used = 0;
+        arena->current = block = fresh;
+    }
+    void *result = block_data(block) + block->used;
+    block->used += size;
+    return result;
+}
+
+void web_arena_reset(WebArena *arena) {
+    WebArenaBlock *block = arena->current;
+    if (block == NULL) {
+        return;
+    }
+    if (block->prev == NULL && block->size <= WEB_ARENA_RETAINED_MAX) {
+        block->used = 0;
+        return;
+    }
+    // Überlauf: alle Blöcke freigeben und beim nächsten Mal einen passenden anlegen
+    size_t total = 0;
+    while (block != NULL) {
+        WebArenaBlock *prev = block->prev;
+        total += block->used;
+        free(block);
+        block = prev;
+    }
+    arena->current = NULL;
+    arena->next_block = total <= WEB_ARENA_RETAINED_MAX ? total : 0;
+}
+
+void web_arena_destroy(WebArena *arena) {
+    web_arena_reset(arena);
+    free(arena->current);
+    arena->current = NULL;
+    arena->next_block = 0;
+}
+
+typedef struct PoolBlock {
+    struct PoolBlock *next;
+} PoolBlock;
+
+typedef struct {
+    PoolBlock *head;
+    size_t count;
+} PoolClass;
+
+static WEB_THREAD_LOCAL PoolClass t_pool[POOL_CLASS_COUNT];
+
+// Index der Größenklasse oder -1, wenn cap keine Zweierpotenz im Poolbereich ist
+static int pool_class_index(size_t cap) {
+    if (cap < WEB_BUFFER_POOL_MIN || cap > WEB_BUFFER_POOL_MAX || (cap & (cap - 1)) != 0) {
+        return -1;
+    }
+    int index = 0;
+    for (size_t size = WEB_BUFFER_POOL_MIN; size < cap; size <<= 1) {
+        index++;
+    }
+    return index;
+}
+
+int web_buffer_pool_class(size_t cap) {
+    return pool_class_index(cap) >= 0;
+}
+
+void *web_buffer_pool_acquire(size_t cap) {
+    int index = pool_class_index(cap);
+    if (index >= 0 && t_pool[index].head != NULL) {
+        PoolBlock *block = t_pool[index].head;
+        t_pool[index].head = block->next;
+        t_pool[index].count--;
+        return block;
+    }
+    return malloc(cap);
+}
+
+void web_buffer_pool_release(void *data, size_t cap) {
+    if (data == NULL) {
+        return;
+    }
+    int index = pool_class_index(cap);
+    if (index < 0 || t_pool[index].count >= POOL_CLASS_RETAINED) {
+        free(data);
+        return;
+    }
+    PoolBlock *block = (PoolBlock *)data;
+    block->next = t_pool[index].head;
+    t_pool[index].head = block;
+    t_pool[index].count++;
+}
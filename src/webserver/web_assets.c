@@ -0,0 +1,93 @@
+#include "webserver/web_assets.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WEB_EMBED_ASSETS
+#include "webserver/web_gzip.h"
+
+extern const EmbeddedAsset WEB_EMBEDDED_ASSETS[];
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    char etag[28];
+} GzipVariant;
+
+// Parallel zu WEB_EMBEDDED_ASSETS; wird nur in web_assets_init beschrieben
+static GzipVariant *g_gzip_variants;
+
+void web_assets_init(void) {
+    size_t count = 0;
+    while (WEB_EMBEDDED_ASSETS[count].name != NULL) {
+        count++;
+    }
+    g_gzip_variants = (GzipVariant *)calloc(count > 0 ? count : 1, sizeof *g_gzip_variants);
+    if (g_gzip_variants == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const EmbeddedAsset *asset = &WEB_EMBEDDED_ASSETS[i];
+        GzipVariant *variant = &g_gzip_variants[i];
+        if (!web_gzip_worthwhile(asset->content_type) ||
+            web_gzip_compress(asset->data, asset->size, &variant->data, &variant->size) != 0) {
+            continue;
+        }
+        if (variant->size >= asset->size) {
+            free(variant->data);
+            variant->data = NULL;
+            continue;
+        }
+        snprintf(variant->etag, sizeof variant->etag, "\"%.16s-gz\"", asset->etag + 1);
+    }
+}
+
+int web_assets_embedded(void) {
+    return 1;
+}
+
+const EmbeddedAsset *web_asset_lookup(const char *relative) {
+    if (relative == NULL) {
+        return NULL;
+    }
+    for (const EmbeddedAsset *asset = WEB_EMBEDDED_ASSETS; asset->name != NULL; asset++) {
+        if (strcmp(asset->name, relative) == 0) {
+            return asset;
+        }
+    }
+    return NULL;
+}
+
+int web_asset_gzip_variant(const EmbeddedAsset *asset, EmbeddedVariant *out) {
+    if (g_gzip_variants == NULL) {
+        return 0;
+    }
+    const GzipVariant *variant = &g_gzip_variants[asset - WEB_EMBEDDED_ASSETS];
+    if (variant->data == NULL) {
+        return 0;
+    }
+    out->data = variant->data;
+    out->size = variant->size;
+    out->etag = variant->etag;
+    return 1;
+}
+#else
+void web_assets_init(void) {
+}
+
+int web_assets_embedded(void) {
+    return 0;
+}
+
+const EmbeddedAsset *web_asset_lookup(const char *relative) {
+    (void)relative;
+    return NULL;
+}
+
+int web_asset_gzip_variant(const EmbeddedAsset *asset, EmbeddedVariant *out) {
+    (void)asset;
+    (void)out;
+    return 0;
+}
+#endif
@@ -1,14 +1,57 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "webserver/web_core.h"
 
 #include "config.h"
+#include "number_format.h"
+#include "webserver/web_arena.h"
+#include "webserver/web_assets.h"
+#include "webserver/web_deadline.h"
+#include "webserver/web_limiter.h"
+#include "webserver/web_log.h"
+#include "webserver/web_metrics.h"
 #include "webserver/web_parser.h"
+#include "webserver/web_pool.h"
+#include "webserver/web_reactor.h"
 #include "webserver/web_router.h"
+#include "webserver/web_thread.h"
+#include "webserver/web_trace.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/uio.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_SCAN_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SCAN_WIDTH 16
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
-static int buffer_reserve(Buffer *buf, size_t needed) {
+#define FILE_CHUNK_SIZE 16384
+#define MAX_SEGMENTS 16
+// Pseudo-Längen für format_response_header
+#define BODY_CHUNKED UINT64_MAX
+#define BODY_UNTIL_CLOSE (UINT64_MAX - 1)
+
+int buffer_reserve(Buffer *buf, size_t needed) {
     if (buf->len + needed < buf->cap) {
         return 0;
     }
@@ -16,9 +59,20 @@ static int buffer_reserve(Buffer *buf, size_t needed) {
     while (new_cap < buf->len + needed + 1) {
         new_cap *= 2;
     }
-    char *new_data = (char *)realloc(buf->data, new_cap);
-    if (new_data == NULL) {
-        return -1;
+    char *new_data;
+    if (web_buffer_pool_class(buf->cap)) {
+        // Innerhalb der Größenklassen wird in den nächsten Poolblock umkopiert
+        new_data = (char *)web_buffer_pool_acquire(new_cap);
+        if (new_data == NULL) {
+            return -1;
+        }
+        memcpy(new_data, buf->data, buf->len + 1);
+        web_buffer_pool_release(buf->data, buf->cap);
+    } else {
+        new_data = (char *)realloc(buf->data, new_cap);
+        if (new_data == NULL) {
+            return -1;
+        }
     }
     buf->data = new_data;
     buf->cap = new_cap;
@@ -26,12 +80,12 @@ static int buffer_reserve(Buffer *buf, size_t needed) {
 }
 
 int buffer_init(Buffer *buf) {
-    buf->data = (char *)malloc(1024);
+    buf->data = (char *)web_buffer_pool_acquire(WEB_BUFFER_POOL_MIN);
     if (buf->data == NULL) {
         return -1;
     }
     buf->len = 0;
-    buf->cap = 1024;
+    buf->cap = WEB_BUFFER_POOL_MIN;
     buf->data[0] = '\0';
     return 0;
 }
@@ -55,100 +109,507 @@ int buffer_append_char(Buffer *buf, char c) {
 }
 
 int buffer_append_format(Buffer *buf, const char *fmt, ...) {
+    // Direkt in den freien Rest schreiben; nur wenn er nicht reicht, vergrößern und wiederholen
     va_list args;
     va_start(args, fmt);
-    char temp[512];
-    int written = vsnprintf(temp, sizeof temp, fmt, args);
+    size_t available = buf->cap - buf->len;
+    int written = vsnprintf(buf->data + buf->len, available, fmt, args);
     va_end(args);
     if (written < 0) {
+        buf->data[buf->len] = '\0';
         return -1;
     }
-    if ((size_t)written >= sizeof temp) {
-        size_t needed = (size_t)written + 1;
-        char *dynamic = (char *)malloc(needed);
-        if (dynamic == NULL) {
+    if ((size_t)written >= available) {
+        if (buffer_reserve(buf, (size_t)written) != 0) {
+            buf->data[buf->len] = '\0';
             return -1;
         }
         va_start(args, fmt);
-        vsnprintf(dynamic, needed, fmt, args);
+        vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
         va_end(args);
-        int res = buffer_append(buf, dynamic, (size_t)written);
-        free(dynamic);
-        return res;
     }
-    return buffer_append(buf, temp, (size_t)written);
+    buf->len += (size_t)written;
+    return 0;
+}
+
+int buffer_append_int(Buffer *buf, long long value) {
+    if (buffer_reserve(buf, NUMBER_FORMAT_MAX) != 0) {
+        return -1;
+    }
+    buf->len += format_integer(value, buf->data + buf->len);
+    return 0;
+}
+
+int buffer_append_cents(Buffer *buf, long long cents) {
+    if (buffer_reserve(buf, NUMBER_FORMAT_MAX) != 0) {
+        return -1;
+    }
+    buf->len += format_cents(cents, buf->data + buf->len);
+    return 0;
+}
+
+int buffer_append_fixed(Buffer *buf, double value, int decimals) {
+    if (buffer_reserve(buf, NUMBER_FORMAT_MAX) != 0) {
+        return -1;
+    }
+    buf->len += format_fixed(value, decimals, buf->data + buf->len);
+    return 0;
+}
+
+long long file_mtime_ns(const struct stat *info) {
+#if defined(__APPLE__)
+    return (long long)info->st_mtimespec.tv_sec * 1000000000LL + info->st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    return (long long)info->st_mtim.tv_sec * 1000000000LL + info->st_mtim.tv_nsec;
+#else
+    return (long long)info->st_mtime * 1000000000LL;
+#endif
 }
 
 void buffer_free(Buffer *buf) {
-    free(buf->data);
+    web_buffer_pool_release(buf->data, buf->cap);
     buf->data = NULL;
     buf->len = 0;
     buf->cap = 0;
 }
 
+#ifdef JSON_SCAN_WIDTH
+static unsigned lowest_set_bit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+// Bitmaske der Bytes in p[0..JSON_SCAN_WIDTH), die escaped werden müssen
+static unsigned json_escape_mask(const unsigned char *p) {
+#if JSON_SCAN_WIDTH == 32
+    __m256i chunk = _mm256_loadu_si256((const __m256i *)p);
+    __m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+    __m256i backslash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+    // c <= 0x1F ohne Vorzeichen: max(c, 0x1F) == 0x1F
+    __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F));
+    return (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(quote, backslash), control));
+#else
+    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+    __m128i quote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+    __m128i backslash = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+    __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(quote, backslash), control));
+#endif
+}
+#endif
+
+static int json_needs_escape(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+static char *write_json_escape(char *out, unsigned char c) {
+    static const char HEX[] = "0123456789abcdef";
+    *out++ = '\\';
+    switch (c) {
+        case '\\': *out++ = '\\'; break;
+        case '"': *out++ = '"'; break;
+        case '\n': *out++ = 'n'; break;
+        case '\r': *out++ = 'r'; break;
+        case '\t': *out++ = 't'; break;
+        default:
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = HEX[c >> 4];
+            *out++ = HEX[c & 0xF];
+            break;
+    }
+    return out;
+}
+
 void append_json_string(Buffer *buf, const char *text) {
-    buffer_append_char(buf, '"');
-    for (const unsigned char *p = (const unsigned char *)text; *p; ++p) {
-        unsigned char c = *p;
-        switch (c) {
-            case '\\': buffer_append_str(buf, "\\\\"); break;
-            case '"': buffer_append_str(buf, "\\\""); break;
-            case '\n': buffer_append_str(buf, "\\n"); break;
-            case '\r': buffer_append_str(buf, "\\r"); break;
-            case '\t': buffer_append_str(buf, "\\t"); break;
-            default:
-                if (c < 0x20) {
-                    buffer_append_format(buf, "\\u%04x", c);
-                } else {
-                    buffer_append_char(buf, (char)c);
-                }
-                break;
-        }
-    }
-    buffer_append_char(buf, '"');
-}
-
-void send_response_with_headers(socket_t client, const char *status, const char *content_type,
-                                const char *body, size_t body_len, const char *extra_headers) {
+    size_t len = strlen(text);
+    // Schlimmster Fall: jedes Zeichen wird zu \u00XX
+    if (buffer_reserve(buf, len * 6 + 2) != 0) {
+        return;
+    }
+    const unsigned char *in = (const unsigned char *)text;
+    const unsigned char *end = in + len;
+    char *out = buf->data + buf->len;
+    *out++ = '"';
+    while (in < end) {
+#ifdef JSON_SCAN_WIDTH
+        // Saubere Abschnitte werden blockweise kopiert, nur Treffer einzeln behandelt
+        if (end - in >= JSON_SCAN_WIDTH) {
+            unsigned mask = json_escape_mask(in);
+            if (mask == 0) {
+                memcpy(out, in, JSON_SCAN_WIDTH);
+                out += JSON_SCAN_WIDTH;
+                in += JSON_SCAN_WIDTH;
+                continue;
+            }
+            unsigned clean = lowest_set_bit(mask);
+            memcpy(out, in, clean);
+            out += clean;
+            in += clean;
+            out = write_json_escape(out, *in++);
+            continue;
+        }
+#endif
+        unsigned char c = *in++;
+        if (json_needs_escape(c)) {
+            out = write_json_escape(out, c);
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    *out++ = '"';
+    buf->len = (size_t)(out - buf->data);
+    buf->data[buf->len] = '\0';
+}
+
+void http_client_init(HttpClient *client, socket_t socket, Buffer *out) {
+    client->socket = socket;
+    client->out = out;
+    client->keep_alive = 0;
+    client->file_fd = -1;
+    client->file_offset = 0;
+    client->file_remaining = 0;
+    client->corked = 0;
+    client->holding = 0;
+    client->chunked_ok = 0;
+    client->arena = NULL;
+    client->status = 0;
+    client->route_id = WEB_METRICS_NO_ROUTE;
+    client->write_deadline = NULL;
+}
+
+// Die Schreibfrist begrenzt nur das Warten auf den Client, nicht die Arbeit des Handlers
+static void arm_write_deadline(HttpClient *client) {
+    if (client->write_deadline != NULL) {
+        web_deadline_set(client->write_deadline, WEB_DEADLINE_WRITE);
+    }
+}
+
+static void disarm_write_deadline(HttpClient *client) {
+    if (client->write_deadline != NULL) {
+        web_deadline_clear(client->write_deadline);
+    }
+}
+
+void http_client_set_cork(HttpClient *client, int corked) {
+    corked = corked != 0;
+    if (client->out != NULL || client->corked == corked) {
+        return;
+    }
+    client->corked = corked;
+#if defined(TCP_CORK)
+    setsockopt(client->socket, IPPROTO_TCP, TCP_CORK, &corked, sizeof corked);
+#elif defined(TCP_NOPUSH)
+    setsockopt(client->socket, IPPROTO_TCP, TCP_NOPUSH, &corked, sizeof corked);
+#endif
+}
+
+// Schreibt alle Abschnitte; nach einem kurzen Schreibvorgang geht es ab dem ersten
+// unvollständigen Abschnitt weiter
+static int send_all_segments(socket_t socket, const WebSegment *segments, size_t count) {
+#ifdef _WIN32
+    WSABUF bufs[MAX_SEGMENTS];
+#else
+    struct iovec bufs[MAX_SEGMENTS];
+#endif
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (segments[i].len == 0) {
+            continue;
+        }
+#ifdef _WIN32
+        bufs[used].buf = (char *)segments[i].data;
+        bufs[used].len = (ULONG)segments[i].len;
+#else
+        bufs[used].iov_base = (void *)segments[i].data;
+        bufs[used].iov_len = segments[i].len;
+#endif
+        used++;
+    }
+    size_t first = 0;
+    while (first < used) {
+#ifdef _WIN32
+        DWORD sent_bytes = 0;
+        if (WSASend(socket, bufs + first, (DWORD)(used - first), &sent_bytes, 0, NULL, NULL) != 0) {
+            return -1;
+        }
+        size_t sent = sent_bytes;
+#else
+        ssize_t result = writev(socket, bufs + first, (int)(used - first));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return -1;
+        }
+        size_t sent = (size_t)result;
+#endif
+        web_metrics_add_bytes_out(sent);
+        while (first < used && sent > 0) {
+#ifdef _WIN32
+            size_t len = bufs[first].len;
+#else
+            size_t len = bufs[first].iov_len;
+#endif
+            if (sent < len) {
+#ifdef _WIN32
+                bufs[first].buf += sent;
+                bufs[first].len -= (ULONG)sent;
+#else
+                bufs[first].iov_base = (char *)bufs[first].iov_base + sent;
+                bufs[first].iov_len -= sent;
+#endif
+                sent = 0;
+            } else {
+                sent -= len;
+                first++;
+            }
+        }
+    }
+    return 0;
+}
+
+void send_segments(HttpClient *client, const WebSegment *segments, size_t count) {
+    if (client->out != NULL) {
+        for (size_t i = 0; i < count; i++) {
+            buffer_append(client->out, segments[i].data, segments[i].len);
+        }
+        if (!client->holding || client->out->len < HELD_OUTPUT_MAX) {
+            return;
+        }
+        // Zurückgehaltene Ausgabe nicht unbegrenzt wachsen lassen
+        Buffer *held = client->out;
+        WebSegment pending = { held->data, held->len };
+        client->out = NULL;
+        send_segments(client, &pending, 1);
+        client->out = held;
+        held->len = 0;
+        held->data[0] = '\0';
+        return;
+    }
+    // Mehr Abschnitte als iovecs werden in Gruppen gesendet
+    WEB_TRACE_ENTER(WEB_TRACE_SEND);
+    arm_write_deadline(client);
+    while (count > 0) {
+        size_t batch = count < MAX_SEGMENTS ? count : MAX_SEGMENTS;
+        if (send_all_segments(client->socket, segments, batch) != 0) {
+            web_metrics_count_error(WEB_ERROR_IO);
+            client->keep_alive = 0;
+            break;
+        }
+        segments += batch;
+        count -= batch;
+    }
+    disarm_write_deadline(client);
+    WEB_TRACE_LEAVE();
+}
+
+static void client_send(HttpClient *client, const char *data, size_t len) {
+    WebSegment segment = { data, len };
+    send_segments(client, &segment, 1);
+}
+
+static int send_file_blocking(socket_t socket, int fd, uint64_t size) {
+#ifdef __linux__
+    off_t offset = 0;
+    while ((uint64_t)offset < size) {
+        ssize_t sent = sendfile(socket, fd, &offset, (size_t)(size - (uint64_t)offset));
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return -1;
+        }
+        web_metrics_add_bytes_out((uint64_t)sent);
+    }
+    return 0;
+#else
+    char chunk[FILE_CHUNK_SIZE];
+    while (size > 0) {
+        unsigned int wanted = size < sizeof chunk ? (unsigned int)size : (unsigned int)sizeof chunk;
+        int got = read(fd, chunk, wanted);
+        if (got <= 0) {
+            return -1;
+        }
+        WebSegment segment = { chunk, (size_t)got };
+        if (send_all_segments(socket, &segment, 1) != 0) {
+            return -1;
+        }
+        size -= (uint64_t)got;
+    }
+    return 0;
+#endif
+}
+
+void http_client_hold_output(HttpClient *client, Buffer *held) {
+    held->data = NULL;
+    held->len = 0;
+    held->cap = 0;
+    // Ohne Puffer wird eben direkt gesendet
+    if (client->out != NULL || buffer_init(held) != 0) {
+        return;
+    }
+    client->out = held;
+    client->holding = 1;
+}
+
+void http_client_release_output(HttpClient *client, Buffer *held) {
+    if (client->out != held) {
+        return;
+    }
+    client->out = NULL;
+    client->holding = 0;
+    client_send(client, held->data, held->len);
+    buffer_free(held);
+    if (client->file_fd >= 0) {
+        arm_write_deadline(client);
+        if (send_file_blocking(client->socket, client->file_fd, client->file_remaining) != 0) {
+            web_metrics_count_error(WEB_ERROR_IO);
+            client->keep_alive = 0;
+        }
+        disarm_write_deadline(client);
+        close(client->file_fd);
+        client->file_fd = -1;
+    }
+}
+
+static int format_response_header(HttpClient *client, char *header, size_t header_size,
+                                  const char *status, const char *content_type, uint64_t body_len,
+                                  const char *extra_headers) {
+    client->status = atoi(status);
     const char *extra = extra_headers ? extra_headers : "";
-    char header[768];
-    int header_len = snprintf(header, sizeof header,
+    const char *connection = client->keep_alive ? "keep-alive" : "close";
+    // 304 beschreibt die gecachte Version; eine Länge von 0 wäre dort falsch
+    char length_line[48] = "";
+    if (body_len == BODY_CHUNKED) {
+        snprintf(length_line, sizeof length_line, "Transfer-Encoding: chunked\r\n");
+    } else if (body_len != BODY_UNTIL_CLOSE && strncmp(status, "304", 3) != 0) {
+        snprintf(length_line, sizeof length_line, "Content-Length: %llu\r\n", (unsigned long long)body_len);
+    }
+    int header_len = snprintf(header, header_size,
                               "HTTP/1.1 %s\r\n"
                               "Content-Type: %s\r\n"
-                              "Content-Length: %zu\r\n"
-                              "Connection: close\r\n"
+                              "%s"
+                              "Connection: %s\r\n"
                               "Access-Control-Allow-Origin: *\r\n"
                               "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
                               "Access-Control-Allow-Headers: Content-Type\r\n"
                               "%s"
                               "\r\n",
-                              status, content_type, body_len, extra);
-    if (header_len > 0) {
-        send(client, header, header_len, 0);
+                              status, content_type, length_line, connection, extra);
+    if (header_len < 0 || (size_t)header_len >= header_size) {
+        return -1;
+    }
+    return header_len;
+}
+
+void send_response_with_headers(HttpClient *client, const char *status, const char *content_type,
+                                const char *body, size_t body_len, const char *extra_headers) {
+    char header[768];
+    int header_len = format_response_header(client, header, sizeof header, status, content_type,
+                                            body_len, extra_headers);
+    if (header_len <= 0) {
+        client->keep_alive = 0;
+        return;
+    }
+    // Kopf und Inhalt in einem Systemaufruf, damit sie nicht auf zwei Pakete verteilt werden
+    WebSegment segments[2] = {
+        { header, (size_t)header_len },
+        { body, body != NULL ? body_len : 0 }
+    };
+    send_segments(client, segments, 2);
+}
+
+void send_file_with_headers(HttpClient *client, const char *status, const char *content_type,
+                            int fd, uint64_t size, const char *extra_headers) {
+    char header[768];
+    int header_len = format_response_header(client, header, sizeof header, status, content_type,
+                                            size, extra_headers);
+    if (header_len <= 0) {
+        close(fd);
+        client->keep_alive = 0;
+        return;
     }
-    if (body_len > 0 && body) {
-        send(client, body, (int)body_len, 0);
+    if (client->out != NULL) {
+        client_send(client, header, (size_t)header_len);
+        client->file_fd = fd;
+        client->file_offset = 0;
+        client->file_remaining = size;
+        return;
+    }
+    // Kopf und Dateianfang sollen gemeinsam im ersten Paket landen
+    int was_corked = client->corked;
+    WEB_TRACE_ENTER(WEB_TRACE_SEND);
+    http_client_set_cork(client, 1);
+    arm_write_deadline(client);
+    WebSegment head = { header, (size_t)header_len };
+    if (send_all_segments(client->socket, &head, 1) != 0 ||
+        send_file_blocking(client->socket, fd, size) != 0) {
+        // Inhalt passt nicht mehr zur angekündigten Länge
+        web_metrics_count_error(WEB_ERROR_IO);
+        client->keep_alive = 0;
     }
+    disarm_write_deadline(client);
+    http_client_set_cork(client, was_corked);
+    WEB_TRACE_LEAVE();
+    close(fd);
 }
 
-void send_response(socket_t client, const char *status, const char *content_type,
+void send_response(HttpClient *client, const char *status, const char *content_type,
                    const char *body, size_t body_len) {
     send_response_with_headers(client, status, content_type, body, body_len, NULL);
 }
 
-void send_empty_response(socket_t client, const char *status) {
+void send_empty_response(HttpClient *client, const char *status) {
     send_response(client, status, "text/plain; charset=utf-8", "", 0);
 }
 
-void send_json_response(socket_t client, const char *status, const char *json, size_t len) {
+void send_json_response(HttpClient *client, const char *status, const char *json, size_t len) {
     send_response(client, status, "application/json; charset=utf-8", json, len);
 }
 
-void send_json_string(socket_t client, const char *status, const char *json) {
+void send_json_string(HttpClient *client, const char *status, const char *json) {
     send_json_response(client, status, json, strlen(json));
 }
 
-void send_error(socket_t client, const char *status, const char *message) {
+// Schnelle Abweisung bei Überlast; berührt weder Router noch Datenbank
+static void send_overloaded(HttpClient *client) {
+    static const char BODY[] = "{\"error\":\"Server ist ausgelastet\"}";
+    client->keep_alive = 0;
+    send_response_with_headers(client, "503 Service Unavailable", "application/json; charset=utf-8",
+                               BODY, sizeof BODY - 1, "Retry-After: 1\r\n");
+}
+
+// Weist eine Verbindung bei voller Warteschlange ab, ohne zu blockieren, und schließt sie
+static void reject_overloaded_connection(socket_t socket) {
+    static const char RESPONSE[] =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: application/json; charset=utf-8\r\n"
+        "Content-Length: 34\r\n"
+        "Connection: close\r\n"
+        "Retry-After: 1\r\n"
+        "\r\n"
+        "{\"error\":\"Server ist ausgelastet\"}";
+    // Ein einziger Versuch: passt die Antwort nicht in den Sendepuffer, bleibt es beim Schließen
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    ioctlsocket(socket, FIONBIO, &nonblocking);
+    send(socket, RESPONSE, (int)(sizeof RESPONSE - 1), 0);
+#else
+    // SIGPIPE ist in start_server abgeschaltet
+    send(socket, RESPONSE, sizeof RESPONSE - 1, MSG_DONTWAIT);
+#endif
+    close_socket(socket);
+    web_metrics_record_request(WEB_METRICS_NO_ROUTE, 503, 0);
+}
+
+void send_error(HttpClient *client, const char *status, const char *message) {
     Buffer buf;
     if (buffer_init(&buf) != 0) {
         send_json_string(client, "500 Internal Server Error", "{\"error\":\"Interner Fehler\"}");
@@ -161,26 +622,262 @@ void send_error(socket_t client, const char *status, const char *message) {
     buffer_free(&buf);
 }
 
-void handle_options(socket_t client) {
+int response_stream_begin(ResponseStream *stream, HttpClient *client, const char *status, const char *content_type) {
+    stream->client = client;
+    stream->status = status;
+    stream->content_type = content_type;
+    stream->started = 0;
+    return buffer_init(&stream->body);
+}
+
+// Versucht, out schon während des Handlers zu leeren (Reaktor-Modus und zurückgehaltene
+// Ausgabe im Worker-Modus), damit der Speicher begrenzt bleibt; ein voller Socket wird
+// nicht abgewartet.
+static void drain_reactor_output(HttpClient *client) {
+#if defined(MSG_DONTWAIT) && defined(MSG_NOSIGNAL)
+    Buffer *out = client->out;
+    size_t sent = 0;
+    WEB_TRACE_ENTER(WEB_TRACE_SEND);
+    while (sent < out->len) {
+        ssize_t result = send(client->socket, out->data + sent, out->len - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            break;
+        }
+        sent += (size_t)result;
+    }
+    WEB_TRACE_LEAVE();
+    web_metrics_add_bytes_out(sent);
+    out->len -= sent;
+    memmove(out->data, out->data + sent, out->len + 1);
+#else
+    (void)client;
+#endif
+}
+
+static void stream_send_chunk(ResponseStream *stream) {
+    HttpClient *client = stream->client;
+    char header[768];
+    char size_line[24];
+    WebSegment segments[4];
+    size_t count = 0;
+    if (!stream->started) {
+        // HTTP/1.0 kennt kein chunked; dort endet der Body mit dem Schließen der Verbindung
+        if (!client->chunked_ok) {
+            client->keep_alive = 0;
+        }
+        int header_len = format_response_header(client, header, sizeof header, stream->status,
+                                                stream->content_type,
+                                                client->chunked_ok ? BODY_CHUNKED : BODY_UNTIL_CLOSE, NULL);
+        if (header_len <= 0) {
+            client->keep_alive = 0;
+            return;
+        }
+        segments[count].data = header;
+        segments[count++].len = (size_t)header_len;
+        stream->started = 1;
+    }
+    if (client->chunked_ok) {
+        int size_len = snprintf(size_line, sizeof size_line, "%zx\r\n", stream->body.len);
+        segments[count].data = size_line;
+        segments[count++].len = (size_t)size_len;
+        segments[count].data = stream->body.data;
+        segments[count++].len = stream->body.len;
+        segments[count].data = "\r\n";
+        segments[count++].len = 2;
+    } else {
+        segments[count].data = stream->body.data;
+        segments[count++].len = stream->body.len;
+    }
+    send_segments(client, segments, count);
+    stream->body.len = 0;
+    if (client->out != NULL && client->out->len >= RESPONSE_STREAM_THRESHOLD) {
+        drain_reactor_output(client);
+    }
+}
+
+void response_stream_flush(ResponseStream *stream) {
+    if (stream->body.len >= RESPONSE_STREAM_THRESHOLD) {
+        stream_send_chunk(stream);
+    }
+}
+
+void response_stream_end(ResponseStream *stream) {
+    HttpClient *client = stream->client;
+    if (!stream->started) {
+        send_response(client, stream->status, stream->content_type, stream->body.data, stream->body.len);
+    } else {
+        if (stream->body.len > 0) {
+            stream_send_chunk(stream);
+        }
+        if (client->chunked_ok) {
+            WebSegment last = { "0\r\n\r\n", 5 };
+            send_segments(client, &last, 1);
+        }
+    }
+    buffer_free(&stream->body);
+}
+
+void handle_options(HttpClient *client) {
     send_empty_response(client, "204 No Content");
 }
 
-static void handle_client(socket_t client) {
-    char buffer[MAX_REQUEST_SIZE];
-    size_t length = 0;
-    if (read_http_request(client, buffer, sizeof buffer, &length) != 0) {
+void send_parse_error(HttpClient *client, const HttpParser *parser) {
+    client->keep_alive = 0;
+    web_metrics_count_error(WEB_ERROR_BAD_REQUEST);
+    if (parser->error == HTTP_PARSE_ERROR_TRANSFER_ENCODING) {
+        send_error(client, "501 Not Implemented", "Transfer-Encoding wird nicht unterstützt");
+    } else {
         send_error(client, "400 Bad Request", "Anfrage konnte nicht gelesen werden");
-        return;
     }
+}
+
+void serve_http_request(HttpClient *client, char *request, const HttpParser *parser) {
+    // Das Byte hinter der Anfrage gehört ggf. schon zur nächsten (Pipelining)
+    // und wird beim Terminieren des Bodys überschrieben
+    size_t length = parser->request_len;
+    char next_byte = request[length];
+    uint64_t started_us = web_monotonic_us();
+    client->status = 0;
+    client->route_id = WEB_METRICS_NO_ROUTE;
+    WEB_TRACE_REQUEST_BEGIN();
     HttpRequest req;
-    if (parse_http_request(buffer, length, &req) != 0) {
+    WEB_TRACE_ENTER(WEB_TRACE_PARSE);
+    int parsed = http_request_from_parser(parser, request, &req);
+    WEB_TRACE_LEAVE();
+    if (parsed != 0) {
+        web_metrics_count_error(WEB_ERROR_BAD_REQUEST);
+        client->keep_alive = 0;
         send_error(client, "400 Bad Request", "Anfrage ist ungültig");
+    } else {
+        client->keep_alive = client->keep_alive && req.keep_alive;
+        client->chunked_ok = req.http_1_1;
+        // Erst die vollständig gelesene Anfrage belegt einen Platz, gemessen wird ab hier:
+        // so zählt nur die Bearbeitung, nicht das Hochladen durch den Client
+        if (!web_limiter_try_acquire()) {
+            send_overloaded(client);
+        } else {
+            route_request(client, &req);
+            web_limiter_release(web_monotonic_us() - started_us);
+        }
+    }
+    uint64_t latency_us = web_monotonic_us() - started_us;
+    web_metrics_record_request(client->route_id, client->status, latency_us);
+    web_log_access(parsed == 0 ? req.method : "-", parsed == 0 ? req.path : "-", client->status, latency_us);
+    WEB_TRACE_REQUEST_END(parsed == 0 ? req.method : "-", parsed == 0 ? req.path : "-", client->status);
+    request[length] = next_byte;
+}
+
+// Jeder Worker bedient eine Anfrage nach der anderen und nutzt dafür immer dieselbe Arena
+static WEB_THREAD_LOCAL WebArena t_request_arena;
+
+typedef struct {
+    WebDeadline *deadline;
+    uint64_t accepted_us;   // Bis die erste Anfrage gelesen ist, sonst 0
+} ReadDeadline;
+
+// Vor jedem recv: Leerlauf-, Kopf- oder Body-Frist passend zum Parserstand. Vor der ersten
+// Anfrage gibt es keinen Leerlauf, dort gilt die Kopf-Frist ab der Annahme.
+static void update_read_deadline(const HttpParser *parser, size_t buffered, void *context) {
+    ReadDeadline *read = (ReadDeadline *)context;
+    WebDeadlineKind kind = web_deadline_for_phase(http_parser_phase(parser, buffered));
+    if (read->accepted_us != 0 && kind != WEB_DEADLINE_BODY) {
+        web_deadline_set_since(read->deadline, WEB_DEADLINE_HEADER, read->accepted_us);
+    } else {
+        web_deadline_set(read->deadline, kind);
+    }
+}
+
+static void serve_connection(HttpClient *client, char *buffer, WebDeadline *deadline, uint64_t accepted_us) {
+    socket_t socket = client->socket;
+    size_t buffered = 0;
+    HttpParser parser;
+    http_parser_init(&parser, MAX_REQUEST_SIZE - 1);
+    ReadDeadline read = { deadline, accepted_us };
+    client->write_deadline = deadline;
+    for (int served = 0;; served++) {
+        int status = read_http_request(socket, buffer, MAX_REQUEST_SIZE, &buffered, &parser,
+                                       update_read_deadline, &read);
+        read.accepted_us = 0;
+        if (status > 0) {
+            return;
+        }
+        if (status < 0) {
+            client->keep_alive = 0;
+            if (web_deadline_wants_408(web_deadline_expired(deadline))) {
+                web_metrics_count_error(WEB_ERROR_TIMEOUT);
+                send_error(client, "408 Request Timeout", "Anfrage wurde nicht rechtzeitig übertragen");
+            } else {
+                send_parse_error(client, &parser);
+            }
+            return;
+        }
+        // Wartende Verbindungen haben Vorrang vor weiteren Anfragen auf dieser. Ohne
+        // eindeutiges Body-Ende wird nichts hinter der Anfrage als neue Anfrage gelesen.
+        client->keep_alive = http_parser_body_framed(&parser) &&
+                             served + 1 < g_config.keepalive_max_requests && web_pool_pending() == 0;
+        // Die nächste Anfrage wird schon jetzt geparst; ihr Stand bleibt nach dem
+        // Verschieben gültig, da die Offsets relativ zum Anfragebeginn sind
+        size_t request_len = parser.request_len;
+        HttpParser next;
+        http_parser_init(&next, MAX_REQUEST_SIZE - 1);
+        int pipelined = client->keep_alive &&
+                        http_parser_execute(&next, buffer + request_len, buffered - request_len) == 1;
+        // Liegen schon weitere Anfragen im Puffer, gehen die Antworten gesammelt hinaus
+        http_client_set_cork(client, pipelined);
+        // Lesefrist endet hier; die Schreibfrist läuft nur während der Sendevorgänge
+        web_deadline_clear(deadline);
+        serve_http_request(client, buffer, &parser);
+        web_arena_reset(client->arena);
+        if (!client->keep_alive) {
+            return;
+        }
+        buffered -= request_len;
+        memmove(buffer, buffer + request_len, buffered);
+        parser = next;
+    }
+}
+
+static void handle_client(socket_t socket, uint64_t wait_us) {
+    HttpClient client;
+    http_client_init(&client, socket, NULL);
+    client.arena = &t_request_arena;
+    // Der Anfragepuffer kommt aus dem Pool statt vom Stack des Workers
+    char *buffer = (char *)web_buffer_pool_acquire(MAX_REQUEST_SIZE);
+    if (buffer == NULL) {
         return;
     }
-    route_request(client, &req);
+    WebDeadline deadline;
+    web_deadline_init(&deadline, socket);
+    web_metrics_connection_opened();
+    // Die Kopf-Frist der ersten Anfrage läuft ab der Annahme, also einschließlich Wartezeit
+    serve_connection(&client, buffer, &deadline, web_monotonic_us() - wait_us);
+    web_metrics_connection_closed();
+    web_deadline_clear(&deadline);
+    web_buffer_pool_release(buffer, MAX_REQUEST_SIZE);
+}
+
+static void serve_pooled_connection(socket_t client, uint64_t wait_us) {
+    if (g_config.log_level >= LOG_LEVEL_DEBUG) {
+        WebPoolStats stats;
+        web_pool_stats(&stats);
+        WebLimiterStats limiter;
+        web_limiter_stats(&limiter);
+        web_log_message(LOG_LEVEL_DEBUG,
+                        "Verbindung nach %llu us Wartezeit angenommen (Mittel %llu us, Max %llu us, "
+                        "wartend %zu, Limit %zu, abgewiesen %llu)",
+                        (unsigned long long)wait_us,
+                        (unsigned long long)(stats.dequeued > 0 ? stats.total_wait_us / stats.dequeued : 0),
+                        (unsigned long long)stats.max_wait_us, stats.queued,
+                        limiter.limit, (unsigned long long)limiter.rejected);
+    }
+    handle_client(client, wait_us);
+    close_socket(client);
 }
 
-static int initialize_socket(socket_t *out_socket) {
+static int initialize_socket(socket_t *out_socket, int reuse_port) {
 #ifdef _WIN32
     WSADATA wsa;
     if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
@@ -199,6 +896,20 @@ static int initialize_socket(socket_t *out_socket) {
     setsockopt(server, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof opt);
 #else
     setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof opt);
+#endif
+#ifdef SO_REUSEPORT
+    if (reuse_port && setsockopt(server, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof opt) != 0) {
+        close_socket(server);
+        return -1;
+    }
+#else
+    if (reuse_port) {
+        close_socket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return -1;
+    }
 #endif
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof addr);
@@ -212,7 +923,7 @@ static int initialize_socket(socket_t *out_socket) {
 #endif
         return -1;
     }
-    if (listen(server, 16) == SOCKET_ERROR) {
+    if (listen(server, g_config.listen_backlog > 0 ? g_config.listen_backlog : SOMAXCONN) == SOCKET_ERROR) {
         close_socket(server);
 #ifdef _WIN32
         WSACleanup();
@@ -223,13 +934,107 @@ static int initialize_socket(socket_t *out_socket) {
     return 0;
 }
 
-int run_server(void) {
+typedef struct {
+    socket_t socket;
+    size_t index;
+    int pin;        // 0, wenn die erlaubten CPUs unbekannt sind
+    size_t cpu;
+} ReactorShard;
+
+static void run_reactor_shard(void *arg) {
+    ReactorShard *shard = (ReactorShard *)arg;
+    if (shard->pin && web_thread_pin_to_cpu(shard->cpu) != 0) {
+        WEB_LOG(LOG_LEVEL_WARN, "Shard %zu konnte nicht an CPU %zu gebunden werden", shard->index, shard->cpu);
+    }
+    run_reactor(shard->socket);
+    WEB_LOG(LOG_LEVEL_ERROR, "Ereignisschleife von Shard %zu wurde mit Fehler beendet", shard->index);
+}
+
+// Jeder Shard besitzt einen eigenen SO_REUSEPORT-Socket, eine eigene Ereignisschleife und
+// eigene Verbindungsobjekte; der Kernel verteilt neue Verbindungen auf die Sockets.
+static int run_reactor_shards(socket_t first, size_t shard_count) {
+    ReactorShard *shards = (ReactorShard *)calloc(shard_count, sizeof *shards);
+    if (shards == NULL) {
+        return 1;
+    }
+    shards[0].socket = first;
+    // Reihum auf die CPUs, die der Prozess nutzen darf; die Nummern müssen nicht bei 0
+    // beginnen oder lückenlos sein (cpuset, taskset). Ermittelt vor dem Binden von Shard 0.
+    for (size_t i = 0; i < shard_count; i++) {
+        shards[i].index = i;
+        shards[i].pin = web_thread_allowed_cpu(i, &shards[i].cpu) == 0;
+    }
+    size_t started = 1;
+    for (size_t i = 1; i < shard_count; i++) {
+        if (initialize_socket(&shards[i].socket, 1) != 0) {
+            WEB_LOG(LOG_LEVEL_ERROR, "Listener für Shard %zu konnte nicht geöffnet werden", i);
+            break;
+        }
+        web_thread_t thread;
+        if (web_thread_start(&thread, run_reactor_shard, &shards[i]) != 0) {
+            close_socket(shards[i].socket);
+            break;
+        }
+        started++;
+    }
+    WEB_LOG(LOG_LEVEL_INFO, "Server läuft auf http://localhost:%d (epoll-Reaktor, %zu Shards)",
+            g_config.webserver_port, started);
+    run_reactor_shard(&shards[0]);
+    return 1;
+}
+
+static int start_server(void) {
+    int use_reactor = 0;
+    size_t shard_count = 1;
+    if (g_config.server_mode == CONFIG_SERVER_MODE_EPOLL) {
+        use_reactor = web_reactor_supported();
+        if (!use_reactor) {
+            WEB_LOG(LOG_LEVEL_WARN, "epoll-Modus auf dieser Plattform nicht verfügbar, verwende Worker-Threads");
+        } else {
+            shard_count = g_config.listener_shards == 0 ? web_cpu_count() : g_config.listener_shards;
+        }
+    }
     socket_t server;
-    if (initialize_socket(&server) != 0) {
-        fprintf(stderr, "Server konnte nicht gestartet werden\n");
+    if (initialize_socket(&server, shard_count > 1) != 0) {
+        WEB_LOG(LOG_LEVEL_ERROR, "Server konnte nicht gestartet werden");
+        return 1;
+    }
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    web_assets_init();
+    web_limiter_init();
+    if (web_router_init() != 0) {
+        WEB_LOG(LOG_LEVEL_ERROR, "Routentabelle konnte nicht aufgebaut werden");
+        close_socket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return 1;
+    }
+    if (use_reactor) {
+        if (shard_count > 1) {
+            return run_reactor_shards(server, shard_count);
+        }
+        WEB_LOG(LOG_LEVEL_INFO, "Server läuft auf http://localhost:%d (epoll-Reaktor)", g_config.webserver_port);
+        run_reactor(server);
+        WEB_LOG(LOG_LEVEL_ERROR, "Ereignisschleife wurde mit Fehler beendet");
+        close_socket(server);
+        return 1;
+    }
+    if (web_watchdog_start() != 0 ||
+        web_pool_start(g_config.worker_threads, g_config.connection_queue_depth, serve_pooled_connection) != 0) {
+        WEB_LOG(LOG_LEVEL_ERROR, "Worker-Threads konnten nicht gestartet werden");
+        close_socket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
         return 1;
     }
-    printf("Server läuft auf http://localhost:%d\n", g_config.webserver_port);
+    WebPoolStats stats;
+    web_pool_stats(&stats);
+    WEB_LOG(LOG_LEVEL_INFO, "Server läuft auf http://localhost:%d (%zu Worker, Warteschlange %zu)",
+            g_config.webserver_port, stats.workers, stats.queue_depth);
     for (;;) {
         struct sockaddr_in client_addr;
         socklen_t addr_len = sizeof client_addr;
@@ -237,8 +1042,11 @@ int run_server(void) {
         if (client == INVALID_SOCKET) {
             continue;
         }
-        handle_client(client);
-        close_socket(client);
+        // Die Warteschlange begrenzt wartende Verbindungen; Anfragen prüft erst der Limiter
+        if (web_pool_try_submit(client) != 0) {
+            web_limiter_count_rejection();
+            reject_overloaded_connection(client);
+        }
     }
     close_socket(server);
 #ifdef _WIN32
@@ -246,3 +1054,13 @@ int run_server(void) {
 #endif
     return 0;
 }
+
+int run_server(void) {
+    // Ohne Hintergrund-Thread schreibt der Logger synchron weiter
+    if (web_log_start() != 0) {
+        WEB_LOG(LOG_LEVEL_WARN, "Log-Thread konnte nicht gestartet werden, schreibe synchron");
+    }
+    int result = start_server();
+    web_log_stop();
+    return result;
+}
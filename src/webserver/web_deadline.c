@@ -0,0 +1,108 @@
+#include "webserver/web_deadline.h"
+
+#include "config.h"
+#include "webserver/web_thread.h"
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#define SHUTDOWN_READ SD_RECEIVE
+#define SHUTDOWN_BOTH SD_BOTH
+#else
+#define SHUTDOWN_READ SHUT_RD
+#define SHUTDOWN_BOTH SHUT_RDWR
+#endif
+
+static WebTimerWheel g_wheel;
+static web_mutex_t g_wheel_lock;
+static web_thread_t g_watchdog;
+
+uint64_t web_deadline_timeout_us(WebDeadlineKind kind) {
+    int timeout_ms = 0;
+    switch (kind) {
+        case WEB_DEADLINE_IDLE: timeout_ms = g_config.keepalive_timeout_ms; break;
+        case WEB_DEADLINE_HEADER: timeout_ms = g_config.header_timeout_ms; break;
+        case WEB_DEADLINE_BODY: timeout_ms = g_config.body_timeout_ms; break;
+        case WEB_DEADLINE_WRITE: timeout_ms = g_config.write_timeout_ms; break;
+        case WEB_DEADLINE_NONE: break;
+    }
+    return timeout_ms > 0 ? (uint64_t)timeout_ms * 1000u : 0;
+}
+
+WebDeadlineKind web_deadline_for_phase(HttpReadPhase phase) {
+    switch (phase) {
+        case HTTP_READ_HEADER: return WEB_DEADLINE_HEADER;
+        case HTTP_READ_BODY: return WEB_DEADLINE_BODY;
+        case HTTP_READ_IDLE: break;
+    }
+    return WEB_DEADLINE_IDLE;
+}
+
+int web_deadline_wants_408(WebDeadlineKind kind) {
+    return kind == WEB_DEADLINE_HEADER || kind == WEB_DEADLINE_BODY;
+}
+
+// Läuft unter g_wheel_lock; der Worker hängt seinen Timer vor dem Schließen unter
+// derselben Sperre aus, daher trifft shutdown() nie einen bereits neu vergebenen Socket.
+static void expire_deadline(WebTimer *timer, void *context) {
+    (void)context;
+    WebDeadline *deadline = (WebDeadline *)((char *)timer - offsetof(WebDeadline, timer));
+    deadline->expired = deadline->kind;
+    // Beim Lesen genügt es, recv aufzuwecken; die 408-Antwort kann dann noch hinaus
+    shutdown(deadline->socket, deadline->kind == WEB_DEADLINE_WRITE ? SHUTDOWN_BOTH : SHUTDOWN_READ);
+}
+
+static void watchdog_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        web_sleep_ms(WEB_DEADLINE_TICK_US / 1000u);
+        web_mutex_lock(&g_wheel_lock);
+        web_timer_advance(&g_wheel, web_monotonic_us(), expire_deadline, NULL);
+        web_mutex_unlock(&g_wheel_lock);
+    }
+}
+
+int web_watchdog_start(void) {
+    web_mutex_init(&g_wheel_lock);
+    web_timer_wheel_init(&g_wheel, web_monotonic_us(), WEB_DEADLINE_TICK_US);
+    return web_thread_start(&g_watchdog, watchdog_main, NULL);
+}
+
+void web_deadline_init(WebDeadline *deadline, socket_t socket) {
+    web_timer_init(&deadline->timer);
+    deadline->socket = socket;
+    deadline->kind = WEB_DEADLINE_NONE;
+    deadline->expired = WEB_DEADLINE_NONE;
+}
+
+void web_deadline_set(WebDeadline *deadline, WebDeadlineKind kind) {
+    web_deadline_set_since(deadline, kind, web_monotonic_us());
+}
+
+void web_deadline_set_since(WebDeadline *deadline, WebDeadlineKind kind, uint64_t since_us) {
+    uint64_t timeout_us = web_deadline_timeout_us(kind);
+    web_mutex_lock(&g_wheel_lock);
+    if (deadline->expired == WEB_DEADLINE_NONE && (kind != deadline->kind || !web_timer_pending(&deadline->timer))) {
+        deadline->kind = kind;
+        if (timeout_us > 0) {
+            web_timer_schedule(&g_wheel, &deadline->timer, since_us + timeout_us);
+        } else {
+            web_timer_cancel(&g_wheel, &deadline->timer);
+        }
+    }
+    web_mutex_unlock(&g_wheel_lock);
+}
+
+void web_deadline_clear(WebDeadline *deadline) {
+    web_mutex_lock(&g_wheel_lock);
+    web_timer_cancel(&g_wheel, &deadline->timer);
+    deadline->kind = WEB_DEADLINE_NONE;
+    web_mutex_unlock(&g_wheel_lock);
+}
+
+WebDeadlineKind web_deadline_expired(WebDeadline *deadline) {
+    web_mutex_lock(&g_wheel_lock);
+    WebDeadlineKind expired = deadline->expired;
+    web_mutex_unlock(&g_wheel_lock);
+    return expired;
+}
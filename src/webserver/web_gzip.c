@@ -0,0 +1,215 @@
+#include "webserver/web_gzip.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WINDOW_SIZE 32768u
+#define HASH_BITS 15
+#define HASH_SIZE (1u << HASH_BITS)
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define MAX_CHAIN 64
+#define NO_POS UINT32_MAX
+
+static const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    uint32_t bits;
+    unsigned bit_count;
+} BitWriter;
+
+// DEFLATE schreibt Bits LSB-first; Huffman-Codes selbst aber MSB-first
+static void put_bits(BitWriter *writer, uint32_t value, unsigned count) {
+    writer->bits |= value << writer->bit_count;
+    writer->bit_count += count;
+    while (writer->bit_count >= 8) {
+        writer->data[writer->size++] = (unsigned char)writer->bits;
+        writer->bits >>= 8;
+        writer->bit_count -= 8;
+    }
+}
+
+static void put_code(BitWriter *writer, uint32_t code, unsigned length) {
+    uint32_t reversed = 0;
+    for (unsigned i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1u);
+    }
+    put_bits(writer, reversed, length);
+}
+
+// Feste Huffman-Codes aus RFC 1951, Abschnitt 3.2.6
+static void put_symbol(BitWriter *writer, unsigned symbol) {
+    if (symbol < 144) {
+        put_code(writer, 0x30u + symbol, 8);
+    } else if (symbol < 256) {
+        put_code(writer, 0x190u + (symbol - 144), 9);
+    } else if (symbol < 280) {
+        put_code(writer, symbol - 256, 7);
+    } else {
+        put_code(writer, 0xC0u + (symbol - 280), 8);
+    }
+}
+
+static void put_match(BitWriter *writer, unsigned length, unsigned distance) {
+    unsigned code = 28;
+    while (LENGTH_BASE[code] > length) {
+        code--;
+    }
+    put_symbol(writer, 257 + code);
+    put_bits(writer, length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DIST_BASE[code] > distance) {
+        code--;
+    }
+    put_code(writer, code, 5);
+    put_bits(writer, distance - DIST_BASE[code], DIST_EXTRA[code]);
+}
+
+static uint32_t hash3(const unsigned char *p) {
+    uint32_t value = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint32_t crc32(const unsigned char *data, size_t size) {
+    uint32_t table[256];
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void put_le32(unsigned char *out, uint32_t value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+int web_gzip_compress(const unsigned char *data, size_t size, unsigned char **out, size_t *out_size) {
+    if (size >= NO_POS) {
+        return -1;
+    }
+    // Feste Codes brauchen höchstens 9 Bit pro Literal
+    size_t capacity = 10 + size + size / 8 + 16 + 8;
+    uint32_t *head = (uint32_t *)malloc(HASH_SIZE * sizeof *head);
+    uint32_t *prev = (uint32_t *)malloc(WINDOW_SIZE * sizeof *prev);
+    BitWriter writer = { (unsigned char *)malloc(capacity), 0, 0, 0 };
+    if (head == NULL || prev == NULL || writer.data == NULL) {
+        free(head);
+        free(prev);
+        free(writer.data);
+        return -1;
+    }
+    for (size_t i = 0; i < HASH_SIZE; i++) {
+        head[i] = NO_POS;
+    }
+
+    static const unsigned char header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+    memcpy(writer.data, header, sizeof header);
+    writer.size = sizeof header;
+
+    put_bits(&writer, 1, 1);  // BFINAL
+    put_bits(&writer, 1, 2);  // BTYPE = feste Huffman-Codes
+
+    size_t pos = 0;
+    while (pos < size) {
+        unsigned best_length = 0;
+        unsigned best_distance = 0;
+        if (pos + MIN_MATCH <= size) {
+            uint32_t hash = hash3(data + pos);
+            uint32_t candidate = head[hash];
+            size_t max_length = size - pos < MAX_MATCH ? size - pos : MAX_MATCH;
+            for (int chain = 0; chain < MAX_CHAIN && candidate != NO_POS; chain++) {
+                size_t distance = pos - candidate;
+                if (distance == 0 || distance > WINDOW_SIZE) {
+                    break;
+                }
+                const unsigned char *a = data + candidate;
+                const unsigned char *b = data + pos;
+                if (a[best_length] == b[best_length]) {
+                    size_t length = 0;
+                    while (length < max_length && a[length] == b[length]) {
+                        length++;
+                    }
+                    if (length > best_length) {
+                        best_length = (unsigned)length;
+                        best_distance = (unsigned)distance;
+                        if (length == max_length) {
+                            break;
+                        }
+                    }
+                }
+                uint32_t next = prev[candidate & (WINDOW_SIZE - 1)];
+                if (next == NO_POS || next >= candidate) {
+                    break;
+                }
+                candidate = next;
+            }
+        }
+
+        size_t advance = best_length >= MIN_MATCH ? best_length : 1;
+        if (best_length >= MIN_MATCH) {
+            put_match(&writer, best_length, best_distance);
+        } else {
+            put_symbol(&writer, data[pos]);
+        }
+        for (size_t i = 0; i < advance; i++, pos++) {
+            if (pos + MIN_MATCH <= size) {
+                uint32_t hash = hash3(data + pos);
+                prev[pos & (WINDOW_SIZE - 1)] = head[hash];
+                head[hash] = (uint32_t)pos;
+            }
+        }
+    }
+    put_symbol(&writer, 256);
+    if (writer.bit_count > 0) {
+        put_bits(&writer, 0, 8 - writer.bit_count);
+    }
+
+    put_le32(writer.data + writer.size, crc32(data, size));
+    put_le32(writer.data + writer.size + 4, (uint32_t)size);
+    writer.size += 8;
+
+    free(head);
+    free(prev);
+    *out = writer.data;
+    *out_size = writer.size;
+    return 0;
+}
+
+int web_gzip_worthwhile(const char *content_type) {
+    if (content_type == NULL) {
+        return 0;
+    }
+    return strncmp(content_type, "text/", 5) == 0 ||
+           strstr(content_type, "javascript") != NULL ||
+           strstr(content_type, "json") != NULL ||
+           strstr(content_type, "svg") != NULL;
+}
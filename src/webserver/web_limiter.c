@@ -0,0 +1,135 @@
+#include "webserver/web_limiter.h"
+
+#include "config.h"
+#include "webserver/web_thread.h"
+
+#define LIMITER_WINDOW_SAMPLES 32   // Messungen je Anpassung
+#define LIMITER_LONG_WINDOWS 20     // Glättung der langfristigen Basis in Fenstern
+#define LIMITER_SMOOTHING 0.2       // Anteil des neuen Werts je Anpassung
+#define LIMITER_MIN_GRADIENT 0.5
+
+typedef struct {
+    web_mutex_t mutex;
+    double limit;
+    size_t min_limit;
+    size_t max_limit;           // 0 = ohne Begrenzung
+    size_t in_flight;
+    size_t window_peak;         // Höchste Parallelität im laufenden Fenster
+    uint64_t window_sum_us;
+    size_t window_count;
+    uint64_t short_latency_us;
+    uint64_t long_latency_us;
+    uint64_t admitted;
+    uint64_t rejected;
+} Limiter;
+
+static Limiter g_limiter;
+
+static size_t isqrt(size_t value) {
+    size_t root = 0;
+    while ((root + 1) * (root + 1) <= value) {
+        root++;
+    }
+    return root;
+}
+
+void web_limiter_init(void) {
+    web_mutex_init(&g_limiter.mutex);
+    g_limiter.min_limit = g_config.concurrency_limit_min > 0 ? g_config.concurrency_limit_min : 1;
+    g_limiter.max_limit = g_config.concurrency_limit_max;
+    size_t initial = g_config.concurrency_limit_initial;
+    if (initial < g_limiter.min_limit) {
+        initial = g_limiter.min_limit;
+    }
+    if (g_limiter.max_limit > 0 && initial > g_limiter.max_limit) {
+        initial = g_limiter.max_limit;
+    }
+    g_limiter.limit = (double)initial;
+}
+
+int web_limiter_try_acquire(void) {
+    web_mutex_lock(&g_limiter.mutex);
+    int admitted = g_limiter.max_limit == 0 || (double)g_limiter.in_flight < g_limiter.limit;
+    if (admitted) {
+        g_limiter.in_flight++;
+        g_limiter.admitted++;
+        if (g_limiter.in_flight > g_limiter.window_peak) {
+            g_limiter.window_peak = g_limiter.in_flight;
+        }
+    } else {
+        g_limiter.rejected++;
+    }
+    web_mutex_unlock(&g_limiter.mutex);
+    return admitted;
+}
+
+// Läuft unter der Sperre, einmal je LIMITER_WINDOW_SAMPLES Messungen
+static void adjust_limit(void) {
+    uint64_t short_us = g_limiter.window_sum_us / g_limiter.window_count;
+    if (short_us == 0) {
+        short_us = 1;
+    }
+    if (g_limiter.long_latency_us == 0) {
+        g_limiter.long_latency_us = short_us;
+    } else {
+        double delta = ((double)short_us - (double)g_limiter.long_latency_us) / LIMITER_LONG_WINDOWS;
+        g_limiter.long_latency_us = (uint64_t)((double)g_limiter.long_latency_us + delta);
+    }
+    // Liegt die Basis weit über der aktuellen Latenz (Last vorbei), holt sie schneller auf
+    if (g_limiter.long_latency_us > 2 * short_us) {
+        g_limiter.long_latency_us = g_limiter.long_latency_us * 95 / 100;
+    }
+    g_limiter.short_latency_us = short_us;
+
+    double gradient = (double)g_limiter.long_latency_us / (double)short_us;
+    if (gradient < LIMITER_MIN_GRADIENT) {
+        gradient = LIMITER_MIN_GRADIENT;
+    } else if (gradient > 1.0) {
+        gradient = 1.0;
+    }
+    double headroom = (double)isqrt((size_t)g_limiter.limit);
+    double target = g_limiter.limit * gradient + headroom;
+    // Wachsen nur, wenn das Limit im Fenster wirklich ausgeschöpft wurde
+    if (target > g_limiter.limit && (double)g_limiter.window_peak * 2.0 < g_limiter.limit) {
+        target = g_limiter.limit;
+    }
+    double limit = g_limiter.limit * (1.0 - LIMITER_SMOOTHING) + target * LIMITER_SMOOTHING;
+    if (limit < (double)g_limiter.min_limit) {
+        limit = (double)g_limiter.min_limit;
+    }
+    if (g_limiter.max_limit > 0 && limit > (double)g_limiter.max_limit) {
+        limit = (double)g_limiter.max_limit;
+    }
+    g_limiter.limit = limit;
+    g_limiter.window_sum_us = 0;
+    g_limiter.window_count = 0;
+    g_limiter.window_peak = g_limiter.in_flight;
+}
+
+void web_limiter_release(uint64_t latency_us) {
+    web_mutex_lock(&g_limiter.mutex);
+    g_limiter.in_flight--;
+    g_limiter.window_sum_us += latency_us;
+    g_limiter.window_count++;
+    if (g_limiter.window_count >= LIMITER_WINDOW_SAMPLES) {
+        adjust_limit();
+    }
+    web_mutex_unlock(&g_limiter.mutex);
+}
+
+void web_limiter_count_rejection(void) {
+    web_mutex_lock(&g_limiter.mutex);
+    g_limiter.rejected++;
+    web_mutex_unlock(&g_limiter.mutex);
+}
+
+void web_limiter_stats(WebLimiterStats *out) {
+    web_mutex_lock(&g_limiter.mutex);
+    out->limit = g_limiter.max_limit == 0 ? 0 : (size_t)g_limiter.limit;
+    out->in_flight = g_limiter.in_flight;
+    out->admitted = g_limiter.admitted;
+    out->rejected = g_limiter.rejected;
+    out->short_latency_us = g_limiter.short_latency_us;
+    out->long_latency_us = g_limiter.long_latency_us;
+    web_mutex_unlock(&g_limiter.mutex);
+}
@@ -0,0 +1,323 @@
+#include "webserver/web_log.h"
+
+#include "webserver/web_core.h"
+#include "webserver/web_thread.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _MSC_VER
+typedef volatile LONG64 log_atomic_t;
+#else
+#include <stdatomic.h>
+typedef _Atomic uint64_t log_atomic_t;
+#endif
+
+#define LOG_RING_MASK (WEB_LOG_RING_SIZE - 1u)
+#define LOG_METHOD_MAX 8
+#define LOG_PATH_MAX 192
+#define LOG_BATCH_BYTES 65536
+#define LOG_IDLE_SLEEP_MS 10
+
+typedef enum {
+    LOG_RECORD_MESSAGE,
+    LOG_RECORD_ACCESS
+} LogRecordKind;
+
+// Rohdaten eines Eintrags; formatiert wird erst im Hintergrund-Thread
+typedef struct {
+    LogRecordKind kind;
+    int level;
+    struct timespec time;
+    union {
+        char message[WEB_LOG_MESSAGE_MAX];
+        struct {
+            char method[LOG_METHOD_MAX];
+            char path[LOG_PATH_MAX];
+            int status;
+            uint64_t latency_us;
+        } access;
+    } data;
+} LogRecord;
+
+// Begrenzte MPSC-Warteschlange nach Vyukov: sequence zeigt an, ob der Platz frei
+// (== Position) oder belegt (== Position + 1) ist
+typedef struct {
+    log_atomic_t sequence;
+    LogRecord record;
+} LogSlot;
+
+static LogSlot *g_slots;
+static log_atomic_t g_enqueue_pos;
+static uint64_t g_dequeue_pos;       // Nur der Hintergrund-Thread
+static log_atomic_t g_dropped;
+static log_atomic_t g_stop;
+static log_atomic_t g_running;       // Solange 0, schreiben die Aufrufer selbst
+static web_thread_t g_thread;
+
+static const char *const LEVEL_NAMES[] = { "FEHLER", "WARNUNG", "INFO", "DEBUG" };
+
+#ifdef _MSC_VER
+static uint64_t atomic_load_acquire(log_atomic_t *value) {
+    return (uint64_t)InterlockedCompareExchange64(value, 0, 0);
+}
+
+static void atomic_store_release(log_atomic_t *value, uint64_t desired) {
+    InterlockedExchange64(value, (LONG64)desired);
+}
+
+static int atomic_compare_swap(log_atomic_t *value, uint64_t *expected, uint64_t desired) {
+    LONG64 seen = InterlockedCompareExchange64(value, (LONG64)desired, (LONG64)*expected);
+    if ((uint64_t)seen == *expected) {
+        return 1;
+    }
+    *expected = (uint64_t)seen;
+    return 0;
+}
+
+static uint64_t atomic_exchange_zero(log_atomic_t *value) {
+    return (uint64_t)InterlockedExchange64(value, 0);
+}
+
+static void atomic_increment(log_atomic_t *value) {
+    InterlockedIncrement64(value);
+}
+#else
+static uint64_t atomic_load_acquire(log_atomic_t *value) {
+    return atomic_load_explicit(value, memory_order_acquire);
+}
+
+static void atomic_store_release(log_atomic_t *value, uint64_t desired) {
+    atomic_store_explicit(value, desired, memory_order_release);
+}
+
+static int atomic_compare_swap(log_atomic_t *value, uint64_t *expected, uint64_t desired) {
+    return atomic_compare_exchange_weak_explicit(value, expected, desired, memory_order_relaxed,
+                                                 memory_order_relaxed);
+}
+
+static uint64_t atomic_exchange_zero(log_atomic_t *value) {
+    return atomic_exchange_explicit(value, 0, memory_order_relaxed);
+}
+
+static void atomic_increment(log_atomic_t *value) {
+    atomic_fetch_add_explicit(value, 1, memory_order_relaxed);
+}
+#endif
+
+static void copy_truncated(char *out, size_t out_size, const char *text) {
+    size_t len = strlen(text);
+    if (len >= out_size) {
+        len = out_size - 1;
+    }
+    memcpy(out, text, len);
+    out[len] = '\0';
+}
+
+static void format_record(Buffer *out, const LogRecord *record) {
+    time_t seconds = record->time.tv_sec;
+    struct tm parts;
+#ifdef _WIN32
+    gmtime_s(&parts, &seconds);
+#else
+    gmtime_r(&seconds, &parts);
+#endif
+    char stamp[40];
+    strftime(stamp, sizeof stamp, "%Y-%m-%dT%H:%M:%S", &parts);
+    int level = record->level >= LOG_LEVEL_ERROR && record->level <= LOG_LEVEL_DEBUG ? record->level
+                                                                                        : LOG_LEVEL_DEBUG;
+    buffer_append_str(out, stamp);
+    buffer_append_char(out, '.');
+    long millis = record->time.tv_nsec / 1000000L;
+    buffer_append_char(out, (char)('0' + millis / 100));
+    buffer_append_char(out, (char)('0' + millis / 10 % 10));
+    buffer_append_char(out, (char)('0' + millis % 10));
+    buffer_append_str(out, "Z ");
+    buffer_append_str(out, LEVEL_NAMES[level]);
+    buffer_append_char(out, ' ');
+    if (record->kind == LOG_RECORD_ACCESS) {
+        buffer_append_str(out, record->data.access.method);
+        buffer_append_char(out, ' ');
+        buffer_append_str(out, record->data.access.path);
+        buffer_append_char(out, ' ');
+        buffer_append_int(out, record->data.access.status);
+        buffer_append_char(out, ' ');
+        buffer_append_int(out, (long long)record->data.access.latency_us);
+        buffer_append_str(out, "us\n");
+    } else {
+        buffer_append_str(out, record->data.message);
+        buffer_append_char(out, '\n');
+    }
+}
+
+static void flush_batch(Buffer *batch, FILE *stream) {
+    if (batch->len == 0) {
+        return;
+    }
+    fwrite(batch->data, 1, batch->len, stream);
+    fflush(stream);
+    batch->len = 0;
+}
+
+// Ohne Hintergrund-Thread (Start, Fehlerfall, Herunterfahren) wird sofort geschrieben
+static void write_direct(const LogRecord *record) {
+    Buffer line;
+    if (buffer_init(&line) != 0) {
+        return;
+    }
+    format_record(&line, record);
+    flush_batch(&line, record->level <= LOG_LEVEL_WARN ? stderr : stdout);
+    buffer_free(&line);
+}
+
+static LogSlot *claim_slot(uint64_t *out_pos) {
+    uint64_t pos = atomic_load_acquire(&g_enqueue_pos);
+    for (;;) {
+        LogSlot *slot = &g_slots[pos & LOG_RING_MASK];
+        uint64_t sequence = atomic_load_acquire(&slot->sequence);
+        int64_t diff = (int64_t)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_swap(&g_enqueue_pos, &pos, pos + 1)) {
+                *out_pos = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = atomic_load_acquire(&g_enqueue_pos);
+        }
+    }
+}
+
+static void submit(const LogRecord *record) {
+    if (atomic_load_acquire(&g_running) == 0) {
+        write_direct(record);
+        return;
+    }
+    uint64_t pos;
+    LogSlot *slot = claim_slot(&pos);
+    if (slot == NULL) {
+        atomic_increment(&g_dropped);
+        return;
+    }
+    slot->record = *record;
+    atomic_store_release(&slot->sequence, pos + 1);
+}
+
+static LogRecord *begin_record(LogRecord *record, LogRecordKind kind, int level) {
+    record->kind = kind;
+    record->level = level;
+    timespec_get(&record->time, TIME_UTC);
+    return record;
+}
+
+void web_log_message(int level, const char *fmt, ...) {
+    if (level > g_config.log_level) {
+        return;
+    }
+    LogRecord record;
+    begin_record(&record, LOG_RECORD_MESSAGE, level);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(record.data.message, sizeof record.data.message, fmt, args);
+    va_end(args);
+    submit(&record);
+}
+
+void web_log_access(const char *method, const char *path, int status, uint64_t latency_us) {
+    if (!g_config.access_log || LOG_LEVEL_INFO > g_config.log_level) {
+        return;
+    }
+    LogRecord record;
+    begin_record(&record, LOG_RECORD_ACCESS, LOG_LEVEL_INFO);
+    copy_truncated(record.data.access.method, sizeof record.data.access.method, method);
+    copy_truncated(record.data.access.path, sizeof record.data.access.path, path);
+    record.data.access.status = status;
+    record.data.access.latency_us = latency_us;
+    submit(&record);
+}
+
+// Formatiert alle belegten Plätze; liefert die Anzahl der geschriebenen Einträge
+static size_t drain_ring(Buffer *out_batch, Buffer *err_batch) {
+    size_t drained = 0;
+    for (;;) {
+        LogSlot *slot = &g_slots[g_dequeue_pos & LOG_RING_MASK];
+        if (atomic_load_acquire(&slot->sequence) != g_dequeue_pos + 1) {
+            break;
+        }
+        Buffer *batch = slot->record.level <= LOG_LEVEL_WARN ? err_batch : out_batch;
+        format_record(batch, &slot->record);
+        atomic_store_release(&slot->sequence, g_dequeue_pos + WEB_LOG_RING_SIZE);
+        g_dequeue_pos++;
+        drained++;
+        if (batch->len >= LOG_BATCH_BYTES) {
+            flush_batch(batch, batch == err_batch ? stderr : stdout);
+        }
+    }
+    uint64_t dropped = atomic_exchange_zero(&g_dropped);
+    if (dropped > 0) {
+        buffer_append_format(err_batch, "%llu Logeinträge verworfen (Puffer voll)\n", (unsigned long long)dropped);
+    }
+    flush_batch(err_batch, stderr);
+    flush_batch(out_batch, stdout);
+    return drained;
+}
+
+static void log_thread(void *arg) {
+    (void)arg;
+    Buffer out_batch;
+    Buffer err_batch;
+    if (buffer_init(&out_batch) != 0 || buffer_init(&err_batch) != 0) {
+        return;
+    }
+    // Gewartet wird per Schlafen statt Signal, damit Schreiber nie einen Systemaufruf auslösen
+    for (;;) {
+        int stopping = atomic_load_acquire(&g_stop) != 0;
+        if (drain_ring(&out_batch, &err_batch) == 0) {
+            if (stopping) {
+                break;
+            }
+            web_sleep_ms(LOG_IDLE_SLEEP_MS);
+        }
+    }
+    buffer_free(&out_batch);
+    buffer_free(&err_batch);
+}
+
+int web_log_start(void) {
+    if (atomic_load_acquire(&g_running) != 0) {
+        return 0;
+    }
+    if (g_slots == NULL) {
+        g_slots = (LogSlot *)calloc(WEB_LOG_RING_SIZE, sizeof *g_slots);
+    }
+    if (g_slots == NULL) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < WEB_LOG_RING_SIZE; i++) {
+        atomic_store_release(&g_slots[i].sequence, i);
+    }
+    atomic_store_release(&g_enqueue_pos, 0);
+    g_dequeue_pos = 0;
+    atomic_store_release(&g_stop, 0);
+    atomic_store_release(&g_running, 1);
+    if (web_thread_start(&g_thread, log_thread, NULL) != 0) {
+        atomic_store_release(&g_running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void web_log_stop(void) {
+    if (atomic_load_acquire(&g_running) == 0) {
+        return;
+    }
+    // Neue Einträge gehen ab jetzt direkt hinaus; der Ring bleibt bestehen, weil andere
+    // Threads ihn noch beschreiben können
+    atomic_store_release(&g_running, 0);
+    atomic_store_release(&g_stop, 1);
+    web_thread_join(g_thread);
+}
@@ -0,0 +1,367 @@
+#include "webserver/web_metrics.h"
+
+#include "webserver/web_limiter.h"
+#include "webserver/web_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC: ausgerichtete 64-Bit-Zugriffe sind auf x64 atomar
+typedef volatile uint64_t metric_t;
+typedef void *volatile metric_ptr_t;
+#define METRIC_LOAD(counter) (counter)
+#define METRIC_STORE(counter, value) ((counter) = (value))
+#define METRIC_PTR_LOAD(ptr) (ptr)
+#define METRIC_PTR_PUBLISH(ptr, value) ((ptr) = (value))
+#else
+#include <stdatomic.h>
+typedef _Atomic uint64_t metric_t;
+typedef void *_Atomic metric_ptr_t;
+#define METRIC_LOAD(counter) atomic_load_explicit(&(counter), memory_order_relaxed)
+#define METRIC_STORE(counter, value) atomic_store_explicit(&(counter), (value), memory_order_relaxed)
+#define METRIC_PTR_LOAD(ptr) atomic_load_explicit(&(ptr), memory_order_acquire)
+#define METRIC_PTR_PUBLISH(ptr, value) atomic_store_explicit(&(ptr), (value), memory_order_release)
+#endif
+// Nur der besitzende Thread schreibt, daher genügt Laden und Speichern statt eines atomaren Addierens
+#define METRIC_ADD(counter, value) METRIC_STORE(counter, METRIC_LOAD(counter) + (value))
+
+// Log-lineare Buckets wie bei HDR-Histogrammen: 16 Unterteilungen je Zweierpotenz
+// (höchstens 6,25 % Abweichung) von 1 us bis 2^32 us
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1u << SUB_BUCKET_BITS)
+#define MAX_EXPONENT 32
+#define HISTOGRAM_BUCKETS (SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS)
+#define STATUS_CLASSES 5
+
+typedef struct {
+    metric_t count;
+    metric_t sum_us;
+    metric_t buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+typedef struct ThreadMetrics {
+    // Histogramme werden erst beim ersten Treffer angelegt
+    metric_ptr_t requests[WEB_METRICS_MAX_ROUTES][STATUS_CLASSES];
+    metric_t bytes_in;
+    metric_t bytes_out;
+    metric_t connections_opened;
+    metric_t connections_closed;
+    metric_t errors[WEB_ERROR_KIND_COUNT];
+    struct ThreadMetrics *next;
+} ThreadMetrics;
+
+static const char *g_route_names[WEB_METRICS_MAX_ROUTES] = { "none" };
+static int g_route_count = 1;
+static ThreadMetrics *g_threads;
+static web_mutex_t g_threads_lock;
+static int g_threads_lock_ready;
+static WEB_THREAD_LOCAL ThreadMetrics *t_metrics;
+
+static const char *const ERROR_NAMES[WEB_ERROR_KIND_COUNT] = { "bad_request", "timeout", "io" };
+static const struct {
+    double value;
+    const char *label;
+} QUANTILES[] = { { 0.5, "0.5" }, { 0.9, "0.9" }, { 0.99, "0.99" }, { 0.999, "0.999" } };
+
+int web_metrics_register_route(const char *name) {
+    if (!g_threads_lock_ready) {
+        web_mutex_init(&g_threads_lock);
+        g_threads_lock_ready = 1;
+    }
+    for (int i = 1; i < g_route_count; i++) {
+        if (strcmp(g_route_names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (g_route_count >= WEB_METRICS_MAX_ROUTES) {
+        return WEB_METRICS_NO_ROUTE;
+    }
+    g_route_names[g_route_count] = name;
+    return g_route_count++;
+}
+
+static ThreadMetrics *thread_metrics(void) {
+    if (t_metrics != NULL) {
+        return t_metrics;
+    }
+    ThreadMetrics *metrics = (ThreadMetrics *)calloc(1, sizeof *metrics);
+    if (metrics == NULL || !g_threads_lock_ready) {
+        free(metrics);
+        return NULL;
+    }
+    web_mutex_lock(&g_threads_lock);
+    metrics->next = g_threads;
+    g_threads = metrics;
+    web_mutex_unlock(&g_threads_lock);
+    t_metrics = metrics;
+    return metrics;
+}
+
+static unsigned highest_bit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (unsigned)index;
+#else
+    return 63u - (unsigned)__builtin_clzll(value);
+#endif
+}
+
+static unsigned bucket_index(uint64_t value_us) {
+    if (value_us < SUB_BUCKETS) {
+        return (unsigned)value_us;
+    }
+    if (value_us >= (uint64_t)1 << MAX_EXPONENT) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    unsigned exponent = highest_bit(value_us);
+    unsigned shift = exponent - SUB_BUCKET_BITS;
+    unsigned sub = (unsigned)(value_us >> shift) & (SUB_BUCKETS - 1u);
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+// Größter Wert, der in den Bucket fällt
+static uint64_t bucket_upper_us(unsigned index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    unsigned shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1u) << shift) - 1u;
+}
+
+static int status_class(int status) {
+    if (status < 100 || status > 599) {
+        return STATUS_CLASSES - 1;
+    }
+    return status / 100 - 1;
+}
+
+void web_metrics_record_request(int route_id, int status, uint64_t latency_us) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics == NULL) {
+        return;
+    }
+    if (route_id < 0 || route_id >= WEB_METRICS_MAX_ROUTES) {
+        route_id = WEB_METRICS_NO_ROUTE;
+    }
+    int class_index = status_class(status);
+    Histogram *histogram = (Histogram *)METRIC_PTR_LOAD(metrics->requests[route_id][class_index]);
+    if (histogram == NULL) {
+        histogram = (Histogram *)calloc(1, sizeof *histogram);
+        if (histogram == NULL) {
+            return;
+        }
+        METRIC_PTR_PUBLISH(metrics->requests[route_id][class_index], histogram);
+    }
+    METRIC_ADD(histogram->buckets[bucket_index(latency_us)], 1);
+    METRIC_ADD(histogram->sum_us, latency_us);
+    METRIC_ADD(histogram->count, 1);
+}
+
+void web_metrics_add_bytes_in(uint64_t bytes) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics != NULL) {
+        METRIC_ADD(metrics->bytes_in, bytes);
+    }
+}
+
+void web_metrics_add_bytes_out(uint64_t bytes) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics != NULL) {
+        METRIC_ADD(metrics->bytes_out, bytes);
+    }
+}
+
+void web_metrics_connection_opened(void) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics != NULL) {
+        METRIC_ADD(metrics->connections_opened, 1);
+    }
+}
+
+void web_metrics_connection_closed(void) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics != NULL) {
+        METRIC_ADD(metrics->connections_closed, 1);
+    }
+}
+
+void web_metrics_count_error(WebErrorKind kind) {
+    ThreadMetrics *metrics = thread_metrics();
+    if (metrics != NULL && kind < WEB_ERROR_KIND_COUNT) {
+        METRIC_ADD(metrics->errors[kind], 1);
+    }
+}
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+} MergedHistogram;
+
+typedef struct {
+    MergedHistogram requests[WEB_METRICS_MAX_ROUTES][STATUS_CLASSES];
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t connections_opened;
+    uint64_t connections_closed;
+    uint64_t errors[WEB_ERROR_KIND_COUNT];
+} MergedMetrics;
+
+static void merge_threads(MergedMetrics *merged) {
+    memset(merged, 0, sizeof *merged);
+    web_mutex_lock(&g_threads_lock);
+    for (ThreadMetrics *metrics = g_threads; metrics != NULL; metrics = metrics->next) {
+        for (int route = 0; route < WEB_METRICS_MAX_ROUTES; route++) {
+            for (int cls = 0; cls < STATUS_CLASSES; cls++) {
+                Histogram *histogram = (Histogram *)METRIC_PTR_LOAD(metrics->requests[route][cls]);
+                if (histogram == NULL) {
+                    continue;
+                }
+                MergedHistogram *target = &merged->requests[route][cls];
+                target->count += METRIC_LOAD(histogram->count);
+                target->sum_us += METRIC_LOAD(histogram->sum_us);
+                for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                    target->buckets[i] += METRIC_LOAD(histogram->buckets[i]);
+                }
+            }
+        }
+        merged->bytes_in += METRIC_LOAD(metrics->bytes_in);
+        merged->bytes_out += METRIC_LOAD(metrics->bytes_out);
+        merged->connections_opened += METRIC_LOAD(metrics->connections_opened);
+        merged->connections_closed += METRIC_LOAD(metrics->connections_closed);
+        for (int kind = 0; kind < WEB_ERROR_KIND_COUNT; kind++) {
+            merged->errors[kind] += METRIC_LOAD(metrics->errors[kind]);
+        }
+    }
+    web_mutex_unlock(&g_threads_lock);
+}
+
+static uint64_t histogram_quantile_us(const MergedHistogram *histogram, double quantile) {
+    // Die Buckets werden einzeln gelesen, daher zählt ihre Summe statt count
+    uint64_t total = 0;
+    for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        total += histogram->buckets[i];
+    }
+    uint64_t rank = (uint64_t)(quantile * (double)total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            return bucket_upper_us(i);
+        }
+    }
+    return 0;
+}
+
+static void append_labels(Buffer *out, int route, int cls) {
+    buffer_append_str(out, "{route=\"");
+    buffer_append_str(out, g_route_names[route]);
+    buffer_append_str(out, "\",status=\"");
+    buffer_append_int(out, cls + 1);
+    buffer_append_str(out, "xx\"");
+}
+
+static void append_seconds(Buffer *out, uint64_t microseconds) {
+    buffer_append_fixed(out, (double)microseconds / 1e6, 6);
+}
+
+static void append_metric(Buffer *out, const char *name, const char *type, const char *help, uint64_t value) {
+    buffer_append_str(out, "# HELP ");
+    buffer_append_str(out, name);
+    buffer_append_char(out, ' ');
+    buffer_append_str(out, help);
+    buffer_append_str(out, "\n# TYPE ");
+    buffer_append_str(out, name);
+    buffer_append_char(out, ' ');
+    buffer_append_str(out, type);
+    buffer_append_char(out, '\n');
+    buffer_append_str(out, name);
+    buffer_append_char(out, ' ');
+    buffer_append_int(out, (long long)value);
+    buffer_append_char(out, '\n');
+}
+
+int web_metrics_write_prometheus(Buffer *out) {
+    MergedMetrics *merged = (MergedMetrics *)malloc(sizeof *merged);
+    if (merged == NULL) {
+        return -1;
+    }
+    merge_threads(merged);
+
+    buffer_append_str(out, "# HELP http_requests_total Beantwortete Anfragen je Route und Statusklasse\n"
+                           "# TYPE http_requests_total counter\n");
+    for (int route = 0; route < g_route_count; route++) {
+        for (int cls = 0; cls < STATUS_CLASSES; cls++) {
+            const MergedHistogram *histogram = &merged->requests[route][cls];
+            if (histogram->count == 0) {
+                continue;
+            }
+            buffer_append_str(out, "http_requests_total");
+            append_labels(out, route, cls);
+            buffer_append_str(out, "} ");
+            buffer_append_int(out, (long long)histogram->count);
+            buffer_append_char(out, '\n');
+        }
+    }
+
+    buffer_append_str(out, "# HELP http_request_duration_seconds Bearbeitungszeit je Route und Statusklasse\n"
+                           "# TYPE http_request_duration_seconds summary\n");
+    for (int route = 0; route < g_route_count; route++) {
+        for (int cls = 0; cls < STATUS_CLASSES; cls++) {
+            const MergedHistogram *histogram = &merged->requests[route][cls];
+            if (histogram->count == 0) {
+                continue;
+            }
+            for (size_t q = 0; q < sizeof QUANTILES / sizeof QUANTILES[0]; q++) {
+                buffer_append_str(out, "http_request_duration_seconds");
+                append_labels(out, route, cls);
+                buffer_append_str(out, ",quantile=\"");
+                buffer_append_str(out, QUANTILES[q].label);
+                buffer_append_str(out, "\"} ");
+                append_seconds(out, histogram_quantile_us(histogram, QUANTILES[q].value));
+                buffer_append_char(out, '\n');
+            }
+            buffer_append_str(out, "http_request_duration_seconds_sum");
+            append_labels(out, route, cls);
+            buffer_append_str(out, "} ");
+            append_seconds(out, histogram->sum_us);
+            buffer_append_str(out, "\nhttp_request_duration_seconds_count");
+            append_labels(out, route, cls);
+            buffer_append_str(out, "} ");
+            buffer_append_int(out, (long long)histogram->count);
+            buffer_append_char(out, '\n');
+        }
+    }
+
+    append_metric(out, "http_bytes_received_total", "counter", "Empfangene Bytes", merged->bytes_in);
+    append_metric(out, "http_bytes_sent_total", "counter", "Gesendete Bytes", merged->bytes_out);
+    append_metric(out, "http_connections_total", "counter", "Angenommene Verbindungen", merged->connections_opened);
+    uint64_t open = merged->connections_opened >= merged->connections_closed
+                        ? merged->connections_opened - merged->connections_closed : 0;
+    append_metric(out, "http_connections_open", "gauge", "Offene Verbindungen", open);
+
+    buffer_append_str(out, "# HELP http_errors_total Fehler nach Art\n# TYPE http_errors_total counter\n");
+    for (int kind = 0; kind < WEB_ERROR_KIND_COUNT; kind++) {
+        buffer_append_str(out, "http_errors_total{kind=\"");
+        buffer_append_str(out, ERROR_NAMES[kind]);
+        buffer_append_str(out, "\"} ");
+        buffer_append_int(out, (long long)merged->errors[kind]);
+        buffer_append_char(out, '\n');
+    }
+
+    WebLimiterStats limiter;
+    web_limiter_stats(&limiter);
+    append_metric(out, "http_concurrency_limit", "gauge", "Aktuelles adaptives Anfragelimit (0 = aus)", limiter.limit);
+    append_metric(out, "http_requests_in_flight", "gauge", "Gerade bearbeitete Anfragen", limiter.in_flight);
+    append_metric(out, "http_requests_rejected_total", "counter", "Wegen Überlast mit 503 abgewiesen",
+                  limiter.rejected);
+    free(merged);
+    return 0;
+}
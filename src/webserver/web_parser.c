@@ -1,6 +1,10 @@
 #include "webserver/web_parser.h"
 
+#include "webserver/web_metrics.h"
+#include "webserver/web_trace.h"
+
 #include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,76 +22,49 @@ static int hex_value(char c) {
     return -1;
 }
 
-static void url_decode(const char *src, char *dest, size_t dest_size) {
-    size_t di = 0;
-    for (size_t i = 0; src[i] && di + 1 < dest_size; ) {
-        if (src[i] == '%' && src[i + 1] != '\0' && src[i + 2] != '\0') {
-            int h1 = hex_value(src[i + 1]);
-            int h2 = hex_value(src[i + 2]);
+// Dekodiert text an Ort und Stelle; das Ergebnis ist nie länger als die Eingabe
+static size_t url_decode_in_place(char *text) {
+    char *out = text;
+    for (const char *in = text; *in != '\0'; ) {
+        if (in[0] == '%' && in[1] != '\0' && in[2] != '\0') {
+            int h1 = hex_value(in[1]);
+            int h2 = hex_value(in[2]);
             if (h1 >= 0 && h2 >= 0) {
-                dest[di++] = (char)((h1 << 4) | h2);
-                i += 3;
+                *out++ = (char)((h1 << 4) | h2);
+                in += 3;
                 continue;
             }
         }
-        if (src[i] == '+') {
-            dest[di++] = ' ';
-            i++;
-        } else {
-            dest[di++] = src[i++];
-        }
+        *out++ = *in == '+' ? ' ' : *in;
+        in++;
     }
-    dest[di] = '\0';
+    *out = '\0';
+    return (size_t)(out - text);
 }
 
-static void copy_and_decode_segment(const char *start, size_t length, char *decoded, size_t decoded_size) {
-    if (decoded_size == 0) {
-        return;
-    }
-    size_t raw_capacity = decoded_size * 3;
-    if (raw_capacity == 0) {
-        decoded[0] = '\0';
-        return;
-    }
-    size_t usable = length;
-    if (usable >= raw_capacity) {
-        usable = raw_capacity - 1;
-    }
-    char raw[raw_capacity];
-    if (usable > 0) {
-        memcpy(raw, start, usable);
-    }
-    raw[usable] = '\0';
-    url_decode(raw, decoded, decoded_size);
-}
-
-static void set_param(Param *param, const char *key, const char *value) {
-    strncpy(param->key, key, MAX_KEY_LEN - 1);
-    param->key[MAX_KEY_LEN - 1] = '\0';
-    strncpy(param->value, value, MAX_VALUE_LEN - 1);
-    param->value[MAX_VALUE_LEN - 1] = '\0';
-}
-
-static int parse_form_params(const char *data, Param *params, int max_params) {
+// Zerlegt data an Ort und Stelle: '&' und '=' werden zu Terminatoren
+static int parse_form_params(char *data, Param *params, int max_params) {
     if (data == NULL) {
         return 0;
     }
     int count = 0;
-    const char *p = data;
+    char *p = data;
     while (*p && count < max_params) {
-        const char *amp = strchr(p, '&');
-        const char *end = amp ? amp : (p + strlen(p));
-        const char *eq = memchr(p, '=', (size_t)(end - p));
-        char key_buf[MAX_KEY_LEN];
-        char value_buf[MAX_VALUE_LEN];
+        char *amp = strchr(p, '&');
+        char *end = amp ? amp : (p + strlen(p));
+        if (amp != NULL) {
+            *amp = '\0';
+        }
+        char *eq = memchr(p, '=', (size_t)(end - p));
+        char *value = end;
         if (eq != NULL) {
-            copy_and_decode_segment(p, (size_t)(eq - p), key_buf, sizeof key_buf);
-            copy_and_decode_segment(eq + 1, (size_t)(end - eq - 1), value_buf, sizeof value_buf);
-        } else {
-            copy_and_decode_segment(p, (size_t)(end - p), key_buf, sizeof key_buf);
-            value_buf[0] = '\0';
+            *eq = '\0';
+            value = eq + 1;
         }
-        set_param(&params[count], key_buf, value_buf);
+        params[count].key = p;
+        params[count].key_len = url_decode_in_place(p);
+        params[count].value = value;
+        params[count].value_len = url_decode_in_place(value);
         count++;
         if (amp == NULL) {
             break;
@@ -120,133 +97,343 @@ static int case_insensitive_prefix(const char *text, const char *prefix) {
     return 1;
 }
 
-int parse_http_request(char *buffer, size_t length, HttpRequest *req) {
-    (void)length;
-    memset(req, 0, sizeof *req);
-    char *header_end = strstr(buffer, "\r\n\r\n");
-    if (header_end == NULL) {
-        return -1;
+static int header_has_token(const char *value, const char *token) {
+    size_t token_len = strlen(token);
+    for (const char *p = value; *p != '\0'; p++) {
+        if (case_insensitive_prefix(p, token)) {
+            char after = p[token_len];
+            if (after == '\0' || after == ',' || after == ' ' || after == ';') {
+                return 1;
+            }
+        }
     }
-    char *line_end = strstr(buffer, "\r\n");
-    if (line_end == NULL) {
-        return -1;
+    return 0;
+}
+
+// Wertet Accept-Encoding aus; ein explizites gzip hat Vorrang vor "*"
+static int accept_encoding_allows_gzip(const char *value) {
+    int wildcard = 0;
+    const char *p = value;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        const char *name = p;
+        while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ') {
+            p++;
+        }
+        size_t name_len = (size_t)(p - name);
+        double quality = 1.0;
+        while (*p != '\0' && *p != ',') {
+            if (*p == ';') {
+                const char *param = p + 1;
+                while (*param == ' ') {
+                    param++;
+                }
+                if ((param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                    quality = strtod(param + 2, NULL);
+                }
+            }
+            p++;
+        }
+        int allowed = quality > 0.0;
+        if ((name_len == 4 && case_insensitive_prefix(name, "gzip")) ||
+            (name_len == 6 && case_insensitive_prefix(name, "x-gzip"))) {
+            return allowed;
+        }
+        if (name_len == 1 && name[0] == '*') {
+            wildcard = allowed;
+        }
     }
-    *line_end = '\0';
-    char target[512];
-    char version[32];
-    if (sscanf(buffer, "%7s %511s %31s", req->method, target, version) != 3) {
+    return wildcard;
+}
+
+static int is_token_char(unsigned char c) {
+    return c > 0x20 && c < 0x7f && strchr("()<>@,;:\\\"/[]?={}", c) == NULL;
+}
+
+static int span_equals(const char *buffer, HttpSpan span, const char *text) {
+    return strlen(text) == span.length && case_insensitive_prefix(buffer + span.offset, text);
+}
+
+static void copy_span(const char *buffer, HttpSpan span, char *dest, size_t dest_size) {
+    size_t length = span.length < dest_size - 1 ? span.length : dest_size - 1;
+    memcpy(dest, buffer + span.offset, length);
+    dest[length] = '\0';
+}
+
+void http_parser_init(HttpParser *parser, size_t max_size) {
+    memset(parser, 0, sizeof *parser);
+    parser->state = HTTP_PARSE_REQUEST_START;
+    parser->max_size = max_size;
+}
+
+static int finish_header(HttpParser *parser, const char *buffer, size_t value_end) {
+    HttpHeaderSpan header;
+    header.name = parser->header_name;
+    header.value.offset = parser->value_start;
+    header.value.length = value_end - parser->value_start;
+    // Der Body wird nur über Content-Length abgegrenzt. Alles, was eine andere Grenze
+    // nahelegen könnte, wird abgelehnt, sonst würde ein Rest des Bodys bei Keep-Alive
+    // als nächste Anfrage gelesen (Request Smuggling).
+    if (span_equals(buffer, header.name, "Transfer-Encoding")) {
+        parser->error = HTTP_PARSE_ERROR_TRANSFER_ENCODING;
         return -1;
     }
-    char *query = strchr(target, '?');
-    if (query != NULL) {
-        *query = '\0';
-        strncpy(req->query, query + 1, sizeof req->query - 1);
-        req->query[sizeof req->query - 1] = '\0';
-    }
-    strncpy(req->path, target, sizeof req->path - 1);
-    req->path[sizeof req->path - 1] = '\0';
-    char *headers = line_end + 2;
-    while (headers < header_end) {
-        char *next = strstr(headers, "\r\n");
-        if (next == NULL || headers == next) {
-            break;
+    if (span_equals(buffer, header.name, "Content-Length")) {
+        if (header.value.length == 0) {
+            return -1;
         }
-        *next = '\0';
-        char *colon = strchr(headers, ':');
-        if (colon != NULL) {
-            *colon = '\0';
-            char *value = colon + 1;
-            while (*value != '\0' && isspace((unsigned char)*value)) {
-                value++;
-            }
-            if (case_insensitive_prefix(headers, "Content-Type")) {
-                strncpy(req->content_type, value, sizeof req->content_type - 1);
-                req->content_type[sizeof req->content_type - 1] = '\0';
-            } else if (case_insensitive_prefix(headers, "Content-Length")) {
-                req->content_length = (size_t)strtoul(value, NULL, 10);
+        size_t length = 0;
+        for (size_t i = 0; i < header.value.length; i++) {
+            char c = buffer[header.value.offset + i];
+            if (c < '0' || c > '9' || length > (SIZE_MAX - 9) / 10) {
+                return -1;
             }
+            length = length * 10 + (size_t)(c - '0');
         }
-        headers = next + 2;
-    }
-    req->body = header_end + 4;
-    if (req->content_length > 0) {
-        req->body[req->content_length] = '\0';
+        // Wiederholt ist der Header nur mit identischem Wert zulässig (RFC 9112, 6.3)
+        if (parser->has_content_length && length != parser->content_length) {
+            return -1;
+        }
+        parser->content_length = length;
+        parser->has_content_length = 1;
     }
-    req->query_count = parse_form_params(req->query, req->query_params, MAX_PARAMS);
-    if (req->content_length > 0 && case_insensitive_prefix(req->content_type, "application/x-www-form-urlencoded")) {
-        req->body_count = parse_form_params(req->body, req->body_params, MAX_PARAMS);
+    // Weitere Header werden geparst, aber nicht mehr gespeichert
+    if (parser->header_count < HTTP_MAX_HEADERS) {
+        parser->headers[parser->header_count++] = header;
     }
     return 0;
 }
 
-int read_http_request(socket_t client, char *buffer, size_t buffer_size, size_t *out_len) {
-    size_t total = 0;
-    size_t header_len = 0;
-    size_t expected_body = 0;
-    int headers_parsed = 0;
-    while (total + 1 < buffer_size) {
-        int received = recv(client, buffer + total, (int)(buffer_size - total - 1), 0);
-        if (received <= 0) {
-            return -1;
-        }
-        total += (size_t)received;
-        buffer[total] = '\0';
-        if (headers_parsed == 0) {
-            char *header_end = strstr(buffer, "\r\n\r\n");
-            if (header_end != NULL) {
-                headers_parsed = 1;
-                header_len = (size_t)(header_end + 4 - buffer);
-                char headers_copy[4096];
-                size_t copy_len = header_len < sizeof headers_copy - 1 ? header_len : sizeof headers_copy - 1;
-                memcpy(headers_copy, buffer, copy_len);
-                headers_copy[copy_len] = '\0';
-                char *line = strstr(headers_copy, "\r\n");
-                if (line != NULL) {
-                    line += 2;
+int http_parser_execute(HttpParser *parser, const char *buffer, size_t length) {
+    if (parser->state == HTTP_PARSE_ERROR) {
+        return -1;
+    }
+    size_t pos = parser->pos;
+    while (pos < length && parser->state < HTTP_PARSE_BODY) {
+        unsigned char c = (unsigned char)buffer[pos];
+        switch (parser->state) {
+            case HTTP_PARSE_REQUEST_START:
+                // Leerzeilen vor der Anfrage (z. B. nach einem POST-Body) werden übersprungen
+                if (c != '\r' && c != '\n') {
+                    parser->method.offset = pos;
+                    parser->state = HTTP_PARSE_METHOD;
+                    continue;
                 }
-                while (line != NULL && *line != '\0') {
-                    char *next = strstr(line, "\r\n");
-                    if (next == NULL) {
+                break;
+            case HTTP_PARSE_METHOD:
+                if (c == ' ') {
+                    parser->method.length = pos - parser->method.offset;
+                    if (parser->method.length == 0 || parser->method.length > HTTP_MAX_METHOD_LEN) {
+                        parser->state = HTTP_PARSE_ERROR;
                         break;
                     }
-                    if (line == next) {
+                    parser->path.offset = pos + 1;
+                    parser->state = HTTP_PARSE_TARGET;
+                } else if (!is_token_char(c)) {
+                    parser->state = HTTP_PARSE_ERROR;
+                }
+                break;
+            case HTTP_PARSE_TARGET:
+                if (c == ' ') {
+                    if (parser->has_query) {
+                        parser->query.length = pos - parser->query.offset;
+                    } else {
+                        parser->path.length = pos - parser->path.offset;
+                    }
+                    if (pos == parser->path.offset) {
+                        parser->state = HTTP_PARSE_ERROR;
                         break;
                     }
-                    *next = '\0';
-                    char *colon = strchr(line, ':');
-                    if (colon != NULL) {
-                        *colon = '\0';
-                        char *value = colon + 1;
-                        while (*value != '\0' && isspace((unsigned char)*value)) {
-                            value++;
-                        }
-                        if (case_insensitive_prefix(line, "Content-Length")) {
-                            expected_body = (size_t)strtoul(value, NULL, 10);
-                        }
+                    parser->version.offset = pos + 1;
+                    parser->state = HTTP_PARSE_VERSION;
+                } else if (c == '?' && !parser->has_query) {
+                    parser->path.length = pos - parser->path.offset;
+                    parser->query.offset = pos + 1;
+                    parser->has_query = 1;
+                } else if (c < 0x21 || c == 0x7f) {
+                    parser->state = HTTP_PARSE_ERROR;
+                }
+                break;
+            case HTTP_PARSE_VERSION:
+                if (c == '\r' || c == '\n') {
+                    parser->version.length = pos - parser->version.offset;
+                    if (parser->version.length < 5 || memcmp(buffer + parser->version.offset, "HTTP/", 5) != 0) {
+                        parser->state = HTTP_PARSE_ERROR;
+                        break;
                     }
-                    line = next + 2;
+                    parser->state = c == '\r' ? HTTP_PARSE_LINE_LF : HTTP_PARSE_HEADER_START;
+                } else if (c < 0x21 || c == 0x7f) {
+                    parser->state = HTTP_PARSE_ERROR;
+                }
+                break;
+            case HTTP_PARSE_LINE_LF:
+            case HTTP_PARSE_HEADER_LF:
+                parser->state = c == '\n' ? HTTP_PARSE_HEADER_START : HTTP_PARSE_ERROR;
+                break;
+            case HTTP_PARSE_HEADER_START:
+                if (c == '\r') {
+                    parser->state = HTTP_PARSE_HEADERS_END_LF;
+                } else if (c == '\n') {
+                    parser->state = HTTP_PARSE_HEADERS_END_LF;
+                    continue;
+                } else if (!is_token_char(c)) {
+                    // Auch gefaltete Header (obs-fold) werden abgelehnt
+                    parser->state = HTTP_PARSE_ERROR;
+                } else {
+                    parser->header_name.offset = pos;
+                    parser->state = HTTP_PARSE_HEADER_NAME;
+                }
+                break;
+            case HTTP_PARSE_HEADER_NAME:
+                if (c == ':') {
+                    parser->header_name.length = pos - parser->header_name.offset;
+                    parser->state = HTTP_PARSE_HEADER_VALUE_START;
+                } else if (!is_token_char(c)) {
+                    parser->state = HTTP_PARSE_ERROR;
                 }
-                if (expected_body == 0) {
+                break;
+            case HTTP_PARSE_HEADER_VALUE_START:
+                if (c == ' ' || c == '\t') {
                     break;
                 }
-                size_t have_body = total > header_len ? total - header_len : 0;
-                if (have_body >= expected_body) {
+                parser->value_start = pos;
+                parser->value_end = pos;
+                parser->state = HTTP_PARSE_HEADER_VALUE;
+                continue;
+            case HTTP_PARSE_HEADER_VALUE:
+                if (c == '\r' || c == '\n') {
+                    if (finish_header(parser, buffer, parser->value_end) != 0) {
+                        parser->state = HTTP_PARSE_ERROR;
+                        break;
+                    }
+                    parser->state = c == '\r' ? HTTP_PARSE_HEADER_LF : HTTP_PARSE_HEADER_START;
+                } else if (c != ' ' && c != '\t') {
+                    parser->value_end = pos + 1;
+                }
+                break;
+            case HTTP_PARSE_HEADERS_END_LF:
+                if (c != '\n') {
+                    parser->state = HTTP_PARSE_ERROR;
                     break;
                 }
-            }
-        } else {
-            size_t have_body = total > header_len ? total - header_len : 0;
-            if (have_body >= expected_body) {
+                parser->body_offset = pos + 1;
+                parser->request_len = parser->body_offset + parser->content_length;
+                parser->state = parser->request_len > parser->max_size ? HTTP_PARSE_ERROR : HTTP_PARSE_BODY;
                 break;
+            default:
+                break;
+        }
+        if (parser->state == HTTP_PARSE_ERROR) {
+            if (parser->error == HTTP_PARSE_ERROR_NONE) {
+                parser->error = HTTP_PARSE_ERROR_MALFORMED;
             }
+            parser->pos = pos;
+            return -1;
         }
+        pos++;
+    }
+    parser->pos = pos;
+    if (parser->state == HTTP_PARSE_BODY && length >= parser->request_len) {
+        // Der Body wird nicht Byte für Byte untersucht
+        parser->state = HTTP_PARSE_DONE;
+        parser->pos = parser->request_len;
+    }
+    if (parser->state == HTTP_PARSE_DONE) {
+        return 1;
+    }
+    if (parser->state < HTTP_PARSE_BODY && pos >= parser->max_size) {
+        parser->state = HTTP_PARSE_ERROR;
+        parser->error = HTTP_PARSE_ERROR_MALFORMED;
+        return -1;
     }
-    if (headers_parsed == 0) {
+    return 0;
+}
+
+int http_request_from_parser(const HttpParser *parser, char *buffer, HttpRequest *req) {
+    memset(req, 0, sizeof *req);
+    if (parser->state != HTTP_PARSE_DONE) {
         return -1;
     }
-    if (out_len != NULL) {
-        *out_len = total;
+    copy_span(buffer, parser->method, req->method, sizeof req->method);
+    // Hinter Pfad und Query folgen '?' bzw. ' ', die hier nicht mehr gebraucht werden
+    req->path = buffer + parser->path.offset;
+    req->path[parser->path.length] = '\0';
+    if (parser->has_query) {
+        req->query = buffer + parser->query.offset;
+        req->query[parser->query.length] = '\0';
+    }
+    req->http_1_1 = span_equals(buffer, parser->version, "HTTP/1.1");
+    req->keep_alive = req->http_1_1;
+    req->content_length = parser->content_length;
+    for (size_t i = 0; i < parser->header_count; i++) {
+        HttpSpan name = parser->headers[i].name;
+        HttpSpan value_span = parser->headers[i].value;
+        // Der Wert endet vor CR/LF oder Leerraum; dort darf terminiert werden
+        char *value = buffer + value_span.offset;
+        value[value_span.length] = '\0';
+        if (span_equals(buffer, name, "Content-Type")) {
+            copy_span(buffer, value_span, req->content_type, sizeof req->content_type);
+        } else if (span_equals(buffer, name, "If-None-Match")) {
+            copy_span(buffer, value_span, req->if_none_match, sizeof req->if_none_match);
+        } else if (span_equals(buffer, name, "If-Modified-Since")) {
+            copy_span(buffer, value_span, req->if_modified_since, sizeof req->if_modified_since);
+        } else if (span_equals(buffer, name, "Accept-Encoding")) {
+            req->accepts_gzip = accept_encoding_allows_gzip(value);
+        } else if (span_equals(buffer, name, "Connection")) {
+            if (header_has_token(value, "close")) {
+                req->keep_alive = 0;
+            } else if (header_has_token(value, "keep-alive")) {
+                req->keep_alive = 1;
+            }
+        }
+    }
+    req->body = buffer + parser->body_offset;
+    req->body[req->content_length] = '\0';
+    req->query_count = parse_form_params(req->query, req->query_params, MAX_PARAMS);
+    if (req->content_length > 0 && case_insensitive_prefix(req->content_type, "application/x-www-form-urlencoded")) {
+        req->body_count = parse_form_params(req->body, req->body_params, MAX_PARAMS);
     }
-    buffer[total] = '\0';
     return 0;
 }
+
+int http_parser_body_framed(const HttpParser *parser) {
+    return parser->state == HTTP_PARSE_DONE && parser->error == HTTP_PARSE_ERROR_NONE;
+}
+
+HttpReadPhase http_parser_phase(const HttpParser *parser, size_t buffered) {
+    if (parser->state == HTTP_PARSE_BODY || parser->state == HTTP_PARSE_DONE) {
+        return HTTP_READ_BODY;
+    }
+    return buffered == 0 ? HTTP_READ_IDLE : HTTP_READ_HEADER;
+}
+
+int read_http_request(socket_t client, char *buffer, size_t buffer_size, size_t *buffered, HttpParser *parser,
+                      http_read_hook hook, void *context) {
+    size_t total = *buffered;
+    WEB_TRACE_ENTER(WEB_TRACE_PARSE);
+    int status = http_parser_execute(parser, buffer, total);
+    WEB_TRACE_LEAVE();
+    while (status == 0 && total + 1 < buffer_size) {
+        if (hook != NULL) {
+            hook(parser, total, context);
+        }
+        int received = recv(client, buffer + total, (int)(buffer_size - total - 1), 0);
+        if (received <= 0) {
+            *buffered = total;
+            return total == 0 ? 1 : -1;
+        }
+        if (total == 0) {
+            WEB_TRACE_FIRST_BYTE();
+        }
+        total += (size_t)received;
+        web_metrics_add_bytes_in((uint64_t)received);
+        // Nur die neuen Bytes werden untersucht
+        WEB_TRACE_ENTER(WEB_TRACE_PARSE);
+        status = http_parser_execute(parser, buffer, total);
+        WEB_TRACE_LEAVE();
+    }
+    *buffered = total;
+    return status > 0 ? 0 : -1;
+}
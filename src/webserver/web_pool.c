@@ -0,0 +1,132 @@
+#include "webserver/web_pool.h"
+
+#include "webserver/web_thread.h"
+
+#include <stdlib.h>
+
+#define WEB_POOL_MIN_AUTO_WORKERS 4
+
+typedef struct {
+    socket_t socket;
+    uint64_t enqueued_us;
+} PendingConnection;
+
+typedef struct {
+    PendingConnection *slots;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    web_mutex_t mutex;
+    web_cond_t not_empty;
+    web_connection_handler handler;
+    size_t workers;
+    size_t busy_workers;
+    uint64_t dequeued;
+    uint64_t total_wait_us;
+    uint64_t max_wait_us;
+} ConnectionQueue;
+
+static ConnectionQueue g_queue;
+
+static void worker_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        web_mutex_lock(&g_queue.mutex);
+        while (g_queue.count == 0) {
+            web_cond_wait(&g_queue.not_empty, &g_queue.mutex);
+        }
+        PendingConnection pending = g_queue.slots[g_queue.head];
+        g_queue.head = (g_queue.head + 1) % g_queue.capacity;
+        g_queue.count--;
+        uint64_t now = web_monotonic_us();
+        uint64_t wait_us = now > pending.enqueued_us ? now - pending.enqueued_us : 0;
+        g_queue.dequeued++;
+        g_queue.total_wait_us += wait_us;
+        if (wait_us > g_queue.max_wait_us) {
+            g_queue.max_wait_us = wait_us;
+        }
+        g_queue.busy_workers++;
+        web_mutex_unlock(&g_queue.mutex);
+
+        g_queue.handler(pending.socket, wait_us);
+
+        web_mutex_lock(&g_queue.mutex);
+        g_queue.busy_workers--;
+        web_mutex_unlock(&g_queue.mutex);
+    }
+}
+
+int web_pool_start(size_t worker_count, size_t queue_depth, web_connection_handler handler) {
+    if (handler == NULL) {
+        return -1;
+    }
+    if (worker_count == 0) {
+        // Worker blockieren auf Socket- und Datei-I/O, daher mehr Threads als Kerne
+        worker_count = web_cpu_count() * 2;
+        if (worker_count < WEB_POOL_MIN_AUTO_WORKERS) {
+            worker_count = WEB_POOL_MIN_AUTO_WORKERS;
+        }
+    }
+    if (queue_depth == 0) {
+        queue_depth = worker_count;
+    }
+    g_queue.slots = (PendingConnection *)calloc(queue_depth, sizeof *g_queue.slots);
+    if (g_queue.slots == NULL) {
+        return -1;
+    }
+    g_queue.capacity = queue_depth;
+    g_queue.handler = handler;
+    web_mutex_init(&g_queue.mutex);
+    web_cond_init(&g_queue.not_empty);
+    for (size_t i = 0; i < worker_count; i++) {
+        web_thread_t thread;
+        if (web_thread_start(&thread, worker_main, NULL) != 0) {
+            break;
+        }
+        g_queue.workers++;
+    }
+    if (g_queue.workers == 0) {
+        free(g_queue.slots);
+        g_queue.slots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void enqueue_locked(socket_t client) {
+    size_t tail = (g_queue.head + g_queue.count) % g_queue.capacity;
+    g_queue.slots[tail].socket = client;
+    g_queue.slots[tail].enqueued_us = web_monotonic_us();
+    g_queue.count++;
+    web_cond_signal(&g_queue.not_empty);
+}
+
+int web_pool_try_submit(socket_t client) {
+    web_mutex_lock(&g_queue.mutex);
+    if (g_queue.count == g_queue.capacity) {
+        web_mutex_unlock(&g_queue.mutex);
+        return -1;
+    }
+    enqueue_locked(client);
+    web_mutex_unlock(&g_queue.mutex);
+    return 0;
+}
+
+size_t web_pool_pending(void) {
+    web_mutex_lock(&g_queue.mutex);
+    size_t pending = g_queue.count;
+    web_mutex_unlock(&g_queue.mutex);
+    return pending;
+}
+
+void web_pool_stats(WebPoolStats *out) {
+    web_mutex_lock(&g_queue.mutex);
+    out->dequeued = g_queue.dequeued;
+    out->total_wait_us = g_queue.total_wait_us;
+    out->max_wait_us = g_queue.max_wait_us;
+    out->queued = g_queue.count;
+    out->busy_workers = g_queue.busy_workers;
+    out->workers = g_queue.workers;
+    out->queue_depth = g_queue.capacity;
+    web_mutex_unlock(&g_queue.mutex);
+}
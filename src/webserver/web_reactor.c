@@ -0,0 +1,456 @@
+#include "webserver/web_reactor.h"
+
+#ifdef __linux__
+
+#include "config.h"
+#include "webserver/web_deadline.h"
+#include "webserver/web_metrics.h"
+#include "webserver/web_parser.h"
+#include "webserver/web_thread.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+#define REACTOR_MAX_EVENTS 256
+#define REACTOR_READ_CHUNK 4096
+#define REACTOR_FREE_LIST_MAX 1024
+#define REACTOR_RETAINED_BUFFER 16384
+
+typedef enum {
+    CONN_READING,
+    CONN_WRITING
+} ConnectionState;
+
+typedef struct ReactorConnection {
+    socket_t socket;
+    ConnectionState state;
+    Buffer in;
+    HttpParser parser;               // Stand der Anfrage am Anfang von `in`
+    Buffer out;
+    size_t out_sent;
+    int file_fd;                     // Dateiinhalt, der nach `out` gesendet wird
+    off_t file_offset;
+    uint64_t file_remaining;
+    int keep_alive;
+    int requests_served;
+    WebTimer timer;                  // Frist der aktuellen Phase
+    WebDeadlineKind deadline;
+    struct ReactorConnection *next;  // Freiliste
+} ReactorConnection;
+
+// Jeder Reaktor (Shard) verwaltet Verbindungen, Arena und Timer selbst. Gemeinsam mit den
+// anderen Shards bleiben die Caches, die Datensperre und das Anfragelimit (siehe README).
+typedef struct {
+    int epoll_fd;
+    ReactorConnection *free_list;
+    size_t free_count;
+    WebArena arena;                  // Anfragen werden nacheinander im Reaktor-Thread beantwortet
+    WebTimerWheel timers;            // Fristen aller Verbindungen dieses Shards
+    uint64_t now_us;                 // Zeitpunkt nach dem letzten epoll_wait
+} Reactor;
+
+static int set_nonblocking(socket_t socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Plant die Frist für kind ab jetzt; bleibt die Art gleich, läuft die bisherige Frist weiter
+static void set_deadline(Reactor *reactor, ReactorConnection *conn, WebDeadlineKind kind) {
+    if (kind == conn->deadline && web_timer_pending(&conn->timer)) {
+        return;
+    }
+    conn->deadline = kind;
+    uint64_t timeout_us = web_deadline_timeout_us(kind);
+    if (timeout_us == 0) {
+        web_timer_cancel(&reactor->timers, &conn->timer);
+        return;
+    }
+    web_timer_schedule(&reactor->timers, &conn->timer, reactor->now_us + timeout_us);
+}
+
+static void set_read_deadline(Reactor *reactor, ReactorConnection *conn) {
+    set_deadline(reactor, conn, web_deadline_for_phase(http_parser_phase(&conn->parser, conn->in.len)));
+}
+
+static ReactorConnection *acquire_connection(Reactor *reactor, socket_t socket) {
+    ReactorConnection *conn = reactor->free_list;
+    if (conn != NULL) {
+        reactor->free_list = conn->next;
+        reactor->free_count--;
+    } else {
+        conn = (ReactorConnection *)calloc(1, sizeof *conn);
+        if (conn == NULL) {
+            return NULL;
+        }
+        if (buffer_init(&conn->in) != 0 || buffer_init(&conn->out) != 0) {
+            buffer_free(&conn->in);
+            free(conn);
+            return NULL;
+        }
+    }
+    conn->socket = socket;
+    conn->state = CONN_READING;
+    http_parser_init(&conn->parser, MAX_REQUEST_SIZE - 1);
+    conn->file_fd = -1;
+    conn->keep_alive = 1;
+    conn->requests_served = 0;
+    web_timer_init(&conn->timer);
+    conn->deadline = WEB_DEADLINE_NONE;
+    conn->next = NULL;
+    return conn;
+}
+
+static void release_connection(Reactor *reactor, ReactorConnection *conn) {
+    if (conn->file_fd >= 0) {
+        close(conn->file_fd);
+        conn->file_fd = -1;
+    }
+    if (reactor->free_count >= REACTOR_FREE_LIST_MAX) {
+        buffer_free(&conn->in);
+        buffer_free(&conn->out);
+        free(conn);
+        return;
+    }
+    // Große Puffer nicht dauerhaft im Shard behalten
+    if (conn->in.cap > REACTOR_RETAINED_BUFFER || conn->out.cap > REACTOR_RETAINED_BUFFER) {
+        buffer_free(&conn->in);
+        buffer_free(&conn->out);
+        if (buffer_init(&conn->in) != 0 || buffer_init(&conn->out) != 0) {
+            buffer_free(&conn->in);
+            free(conn);
+            return;
+        }
+    }
+    conn->in.len = 0;
+    conn->in.data[0] = '\0';
+    conn->out.len = 0;
+    conn->out_sent = 0;
+    conn->next = reactor->free_list;
+    reactor->free_list = conn;
+    reactor->free_count++;
+}
+
+static void close_connection(Reactor *reactor, ReactorConnection *conn) {
+    web_timer_cancel(&reactor->timers, &conn->timer);
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, conn->socket, NULL);
+    close_socket(conn->socket);
+    release_connection(reactor, conn);
+    web_metrics_connection_closed();
+}
+
+// 1 = alles gesendet, 0 = Socket voll, -1 = Fehler
+static int flush_output(ReactorConnection *conn) {
+    // Folgt noch ein Dateiinhalt, wartet der Kopf wie bei TCP_CORK auf ihn
+    int flags = MSG_NOSIGNAL | (conn->file_remaining > 0 ? MSG_MORE : 0);
+    while (conn->out_sent < conn->out.len) {
+        ssize_t sent = send(conn->socket, conn->out.data + conn->out_sent,
+                            conn->out.len - conn->out_sent, flags);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            web_metrics_count_error(WEB_ERROR_IO);
+            return -1;
+        }
+        conn->out_sent += (size_t)sent;
+        web_metrics_add_bytes_out((uint64_t)sent);
+    }
+    conn->out.len = 0;
+    conn->out_sent = 0;
+    while (conn->file_remaining > 0) {
+        ssize_t sent = sendfile(conn->socket, conn->file_fd, &conn->file_offset, (size_t)conn->file_remaining);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            web_metrics_count_error(WEB_ERROR_IO);
+            return -1;
+        }
+        if (sent == 0) {
+            // Datei wurde gekürzt, die angekündigte Länge ist nicht mehr erfüllbar
+            web_metrics_count_error(WEB_ERROR_IO);
+            return -1;
+        }
+        conn->file_remaining -= (uint64_t)sent;
+        web_metrics_add_bytes_out((uint64_t)sent);
+    }
+    if (conn->file_fd >= 0) {
+        close(conn->file_fd);
+        conn->file_fd = -1;
+    }
+    return 1;
+}
+
+static int watch_events(Reactor *reactor, ReactorConnection *conn, uint32_t events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    return epoll_ctl(reactor->epoll_fd, EPOLL_CTL_MOD, conn->socket, &ev);
+}
+
+// Beantwortet alle vollständig gepufferten Anfragen und sendet die Antworten.
+// Liefert -1, wenn die Verbindung dabei geschlossen wurde.
+static int process_requests(Reactor *reactor, ReactorConnection *conn) {
+    HttpClient client;
+    http_client_init(&client, conn->socket, &conn->out);
+    client.arena = &reactor->arena;
+    for (;;) {
+        // Nach einer Dateiantwort erst senden, damit die Reihenfolge erhalten bleibt
+        while (conn->keep_alive && conn->file_fd < 0) {
+            int status = http_parser_execute(&conn->parser, conn->in.data, conn->in.len);
+            if (status == 0) {
+                break;
+            }
+            if (status < 0) {
+                conn->keep_alive = 0;
+                send_parse_error(&client, &conn->parser);
+                break;
+            }
+            client.keep_alive = http_parser_body_framed(&conn->parser) &&
+                                conn->requests_served + 1 < g_config.keepalive_max_requests;
+            size_t request_len = conn->parser.request_len;
+            serve_http_request(&client, conn->in.data, &conn->parser);
+            web_arena_reset(&reactor->arena);
+            conn->requests_served++;
+            conn->keep_alive = client.keep_alive;
+            conn->in.len -= request_len;
+            memmove(conn->in.data, conn->in.data + request_len, conn->in.len + 1);
+            http_parser_init(&conn->parser, MAX_REQUEST_SIZE - 1);
+            if (client.file_fd >= 0) {
+                conn->file_fd = client.file_fd;
+                conn->file_offset = (off_t)client.file_offset;
+                conn->file_remaining = client.file_remaining;
+                client.file_fd = -1;
+            }
+        }
+        if (conn->out.len == 0 && conn->file_fd < 0) {
+            if (!conn->keep_alive) {
+                close_connection(reactor, conn);
+                return -1;
+            }
+            set_read_deadline(reactor, conn);
+            return 0;
+        }
+        int flushed = flush_output(conn);
+        if (flushed < 0 || (flushed > 0 && !conn->keep_alive)) {
+            close_connection(reactor, conn);
+            return -1;
+        }
+        if (flushed == 0) {
+            conn->state = CONN_WRITING;
+            set_deadline(reactor, conn, WEB_DEADLINE_WRITE);
+            if (watch_events(reactor, conn, EPOLLOUT) != 0) {
+                close_connection(reactor, conn);
+                return -1;
+            }
+            return 0;
+        }
+    }
+}
+
+static void handle_readable(Reactor *reactor, ReactorConnection *conn) {
+    while (conn->state == CONN_READING) {
+        if (conn->in.cap - conn->in.len < REACTOR_READ_CHUNK && conn->in.cap < MAX_REQUEST_SIZE) {
+            if (buffer_reserve(&conn->in, REACTOR_READ_CHUNK) != 0) {
+                close_connection(reactor, conn);
+                return;
+            }
+        }
+        size_t space = conn->in.cap - conn->in.len - 1;
+        if (conn->in.len + space > MAX_REQUEST_SIZE - 1) {
+            space = MAX_REQUEST_SIZE - 1 - conn->in.len;
+        }
+        ssize_t received = recv(conn->socket, conn->in.data + conn->in.len, space, 0);
+        if (received == 0) {
+            close_connection(reactor, conn);
+            return;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                web_metrics_count_error(WEB_ERROR_IO);
+                close_connection(reactor, conn);
+            }
+            return;
+        }
+        conn->in.len += (size_t)received;
+        conn->in.data[conn->in.len] = '\0';
+        web_metrics_add_bytes_in((uint64_t)received);
+        if (process_requests(reactor, conn) != 0) {
+            return;
+        }
+    }
+}
+
+static void handle_writable(Reactor *reactor, ReactorConnection *conn) {
+    int flushed = flush_output(conn);
+    if (flushed == 0) {
+        return;
+    }
+    if (flushed < 0 || !conn->keep_alive) {
+        close_connection(reactor, conn);
+        return;
+    }
+    conn->state = CONN_READING;
+    if (watch_events(reactor, conn, EPOLLIN) != 0) {
+        close_connection(reactor, conn);
+        return;
+    }
+    // Hinter einer Dateiantwort können weitere Anfragen gepuffert sein
+    process_requests(reactor, conn);
+}
+
+static void expire_connection(WebTimer *timer, void *context) {
+    Reactor *reactor = (Reactor *)context;
+    ReactorConnection *conn = (ReactorConnection *)((char *)timer - offsetof(ReactorConnection, timer));
+    if (conn->deadline != WEB_DEADLINE_IDLE) {
+        web_metrics_count_error(WEB_ERROR_TIMEOUT);
+    }
+    // Wer noch gar nichts gesendet hat, bekommt wie im Worker-Modus keine Antwort
+    if (web_deadline_wants_408(conn->deadline) && conn->in.len > 0 && conn->out.len == 0 &&
+        conn->file_fd < 0) {
+        HttpClient client;
+        http_client_init(&client, conn->socket, &conn->out);
+        send_error(&client, "408 Request Timeout", "Anfrage wurde nicht rechtzeitig übertragen");
+        // Nur ein Versuch; passt die Antwort nicht in den Sendepuffer, entfällt sie
+        flush_output(conn);
+    }
+    close_connection(reactor, conn);
+}
+
+static void accept_connections(Reactor *reactor, socket_t server, int *spare_fd) {
+    for (;;) {
+        socket_t socket = accept(server, NULL, NULL);
+        if (socket == INVALID_SOCKET) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EMFILE || errno == ENFILE) && *spare_fd >= 0) {
+                // Reserve-Deskriptor freigeben, Verbindung annehmen und sofort schließen,
+                // damit der Listener nicht dauerhaft lesbar bleibt
+                close(*spare_fd);
+                socket = accept(server, NULL, NULL);
+                if (socket != INVALID_SOCKET) {
+                    close_socket(socket);
+                }
+                *spare_fd = open("/dev/null", O_RDONLY);
+                continue;
+            }
+            return;
+        }
+        if (set_nonblocking(socket) != 0) {
+            close_socket(socket);
+            continue;
+        }
+        ReactorConnection *conn = acquire_connection(reactor, socket);
+        if (conn == NULL) {
+            close_socket(socket);
+            continue;
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, socket, &ev) != 0) {
+            close_socket(socket);
+            release_connection(reactor, conn);
+            continue;
+        }
+        web_metrics_connection_opened();
+        // Vor der ersten Anfrage gibt es keinen Leerlauf: ab der Annahme gilt die Kopf-Frist
+        set_deadline(reactor, conn, WEB_DEADLINE_HEADER);
+    }
+}
+
+int web_reactor_supported(void) {
+    return 1;
+}
+
+int run_reactor(socket_t server) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        return -1;
+    }
+    if (set_nonblocking(server) != 0) {
+        close(epoll_fd);
+        return -1;
+    }
+    struct epoll_event listen_ev;
+    listen_ev.events = EPOLLIN;
+    listen_ev.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server, &listen_ev) != 0) {
+        close(epoll_fd);
+        return -1;
+    }
+    Reactor reactor;
+    memset(&reactor, 0, sizeof reactor);
+    reactor.epoll_fd = epoll_fd;
+    reactor.now_us = web_monotonic_us();
+    web_timer_wheel_init(&reactor.timers, reactor.now_us, WEB_DEADLINE_TICK_US);
+    int spare_fd = open("/dev/null", O_RDONLY);
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    for (;;) {
+        int wait_ms = web_timer_next_timeout_ms(&reactor.timers, reactor.now_us);
+        int ready = epoll_wait(epoll_fd, events, REACTOR_MAX_EVENTS, wait_ms);
+        reactor.now_us = web_monotonic_us();
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            ReactorConnection *conn = (ReactorConnection *)events[i].data.ptr;
+            if (conn == NULL) {
+                accept_connections(&reactor, server, &spare_fd);
+                continue;
+            }
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0) {
+                close_connection(&reactor, conn);
+                continue;
+            }
+            if (conn->state == CONN_READING) {
+                handle_readable(&reactor, conn);
+            } else {
+                handle_writable(&reactor, conn);
+            }
+        }
+        // Erst nach den Ereignissen, damit keines auf eine geschlossene Verbindung zeigt
+        web_timer_advance(&reactor.timers, reactor.now_us, expire_connection, &reactor);
+    }
+    if (spare_fd >= 0) {
+        close(spare_fd);
+    }
+    web_arena_destroy(&reactor.arena);
+    close(epoll_fd);
+    return -1;
+}
+
+#else
+
+int web_reactor_supported(void) {
+    return 0;
+}
+
+int run_reactor(socket_t server) {
+    (void)server;
+    return -1;
+}
+
+#endif
@@ -1,79 +1,204 @@
 #include "webserver/web_router.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "webserver/web_api.h"
 #include "webserver/web_core.h"
+#include "webserver/web_metrics.h"
 #include "webserver/web_static.h"
 
-void route_request(socket_t client, const HttpRequest *req) {
-    if (strcmp(req->method, "OPTIONS") == 0) {
-        handle_options(client);
-        return;
+// Mehrere Routen können sich einen Pfad teilen, wenn sie verschiedene Methoden bedienen
+typedef struct RouteEntry {
+    const WebRoute *route;
+    int metrics_id;
+    struct RouteEntry *next;
+} RouteEntry;
+
+// Knoten eines Radix-Baums; label ist der Pfadabschnitt der eingehenden Kante
+typedef struct RouteNode {
+    char *label;
+    size_t label_len;
+    struct RouteNode **children;
+    size_t child_count;
+    RouteEntry *exact;
+    RouteEntry *prefix;
+} RouteNode;
+
+static RouteNode g_root;
+
+static RouteNode *new_node(const char *label, size_t label_len) {
+    RouteNode *node = (RouteNode *)calloc(1, sizeof *node);
+    if (node == NULL) {
+        return NULL;
     }
-    if (strcmp(req->method, "GET") == 0) {
-        if (strcmp(req->path, "/") == 0) {
-            handle_static_root(client);
-            return;
-        }
-        if (strncmp(req->path, "/static/", 8) == 0) {
-            handle_static_request(client, req->path + 8);
-            return;
-        }
-        if (strcmp(req->path, "/api/db-files") == 0) {
-            handle_db_files(client);
-            return;
-        }
-        if (strcmp(req->path, "/api/db") == 0) {
-            handle_db_get(client, req);
-            return;
-        }
-        if (strcmp(req->path, "/api/list/download") == 0) {
-            handle_list_download(client);
-            return;
-        }
-        if (strcmp(req->path, "/api/list") == 0) {
-            handle_list_get(client);
-            return;
-        }
-        send_error(client, "404 Not Found", "Pfad nicht gefunden");
-        return;
+    node->label = (char *)malloc(label_len + 1);
+    if (node->label == NULL) {
+        free(node);
+        return NULL;
     }
-    if (strcmp(req->method, "POST") == 0) {
-        if (strcmp(req->path, "/api/db/add") == 0) {
-            handle_db_add(client, req);
-            return;
+    memcpy(node->label, label, label_len);
+    node->label[label_len] = '\0';
+    node->label_len = label_len;
+    return node;
+}
+
+static int add_child(RouteNode *parent, RouteNode *child) {
+    RouteNode **children = (RouteNode **)realloc(parent->children, (parent->child_count + 1) * sizeof *children);
+    if (children == NULL) {
+        return -1;
+    }
+    children[parent->child_count++] = child;
+    parent->children = children;
+    return 0;
+}
+
+static RouteNode *find_child(const RouteNode *node, char first) {
+    for (size_t i = 0; i < node->child_count; i++) {
+        if (node->children[i]->label[0] == first) {
+            return node->children[i];
         }
-        if (strcmp(req->path, "/api/db/update") == 0) {
-            handle_db_update(client, req);
-            return;
+    }
+    return NULL;
+}
+
+// Teilt die Kante von node nach `at` Zeichen; node behält den vorderen Teil
+static int split_node(RouteNode *node, size_t at) {
+    RouteNode *tail = new_node(node->label + at, node->label_len - at);
+    if (tail == NULL) {
+        return -1;
+    }
+    tail->children = node->children;
+    tail->child_count = node->child_count;
+    tail->exact = node->exact;
+    tail->prefix = node->prefix;
+    node->children = NULL;
+    node->child_count = 0;
+    node->exact = NULL;
+    node->prefix = NULL;
+    node->label_len = at;
+    node->label[at] = '\0';
+    return add_child(node, tail);
+}
+
+static RouteNode *insert_path(const char *path) {
+    RouteNode *node = &g_root;
+    while (*path != '\0') {
+        RouteNode *child = find_child(node, *path);
+        if (child == NULL) {
+            child = new_node(path, strlen(path));
+            if (child == NULL || add_child(node, child) != 0) {
+                return NULL;
+            }
+            return child;
         }
-        if (strcmp(req->path, "/api/db/delete") == 0) {
-            handle_db_delete(client, req);
-            return;
+        size_t common = 0;
+        while (common < child->label_len && path[common] == child->label[common]) {
+            common++;
         }
-        if (strcmp(req->path, "/api/list/add") == 0) {
-            handle_list_add(client, req);
-            return;
+        if (common < child->label_len && split_node(child, common) != 0) {
+            return NULL;
         }
-        if (strcmp(req->path, "/api/list/update") == 0) {
-            handle_list_update(client, req);
-            return;
+        path += common;
+        node = child;
+    }
+    return node;
+}
+
+int web_router_register(const WebRoute *routes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        RouteNode *node = insert_path(routes[i].path);
+        RouteEntry *entry = (RouteEntry *)malloc(sizeof *entry);
+        if (node == NULL || entry == NULL) {
+            free(entry);
+            return -1;
         }
-        if (strcmp(req->path, "/api/list/delete") == 0) {
-            handle_list_delete(client, req);
-            return;
+        RouteEntry **list = routes[i].prefix ? &node->prefix : &node->exact;
+        entry->route = &routes[i];
+        entry->metrics_id = web_metrics_register_route(routes[i].path);
+        entry->next = *list;
+        *list = entry;
+    }
+    return 0;
+}
+
+int web_router_init(void) {
+    if (web_static_register_routes() != 0 || web_api_register_routes() != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static const RouteEntry *pick_route(const RouteEntry *entry, unsigned method, unsigned *allowed_methods) {
+    for (; entry != NULL; entry = entry->next) {
+        *allowed_methods |= entry->route->methods;
+        if (entry->route->methods & method) {
+            return entry;
         }
-        if (strcmp(req->path, "/api/compare/single") == 0) {
-            handle_compare_single(client, req);
-            return;
+    }
+    return NULL;
+}
+
+static const RouteEntry *match_entry(const char *path, unsigned method, unsigned *allowed_methods) {
+    const RouteNode *node = &g_root;
+    const RouteEntry *best_prefix = g_root.prefix;
+    *allowed_methods = 0;
+    while (*path != '\0') {
+        const RouteNode *child = find_child(node, *path);
+        if (child == NULL || strncmp(path, child->label, child->label_len) != 0) {
+            node = NULL;
+            break;
         }
-        if (strcmp(req->path, "/api/compare/list") == 0) {
-            handle_compare_list(client, req);
-            return;
+        path += child->label_len;
+        node = child;
+        if (node->prefix != NULL) {
+            best_prefix = node->prefix;
         }
-        send_error(client, "404 Not Found", "Pfad nicht gefunden");
+    }
+    if (node != NULL && node->exact != NULL) {
+        return pick_route(node->exact, method, allowed_methods);
+    }
+    if (best_prefix != NULL) {
+        return pick_route(best_prefix, method, allowed_methods);
+    }
+    return NULL;
+}
+
+static unsigned method_bit(const char *method) {
+    if (strcmp(method, "GET") == 0) {
+        return ROUTE_GET;
+    }
+    if (strcmp(method, "POST") == 0) {
+        return ROUTE_POST;
+    }
+    return 0;
+}
+
+// OPTIONS beantwortet route_request für jeden Pfad selbst
+static void send_method_not_allowed(HttpClient *client, unsigned allowed) {
+    static const char BODY[] = "{\"error\":\"Methode nicht erlaubt\"}";
+    char allow[48];
+    snprintf(allow, sizeof allow, "Allow: %s%sOPTIONS\r\n",
+             (allowed & ROUTE_GET) ? "GET, " : "", (allowed & ROUTE_POST) ? "POST, " : "");
+    send_response_with_headers(client, "405 Method Not Allowed", "application/json; charset=utf-8",
+                               BODY, sizeof BODY - 1, allow);
+}
+
+void route_request(HttpClient *client, const HttpRequest *req) {
+    if (strcmp(req->method, "OPTIONS") == 0) {
+        handle_options(client);
         return;
     }
-    send_error(client, "405 Method Not Allowed", "Methode nicht erlaubt");
+    // Auch bei unbekannter Methode suchen, damit 405 die Methoden des Pfads nennen kann
+    unsigned allowed = 0;
+    const RouteEntry *entry = match_entry(req->path, method_bit(req->method), &allowed);
+    if (entry != NULL) {
+        client->route_id = entry->metrics_id;
+        entry->route->handler(client, req);
+    } else if (allowed != 0) {
+        send_method_not_allowed(client, allowed);
+    } else {
+        send_error(client, "404 Not Found", "Pfad nicht gefunden");
+    }
 }
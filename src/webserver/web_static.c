@@ -1,10 +1,24 @@
 #include "webserver/web_static.h"
 
+#include "webserver/web_assets.h"
 #include "webserver/web_core.h"
+#include "webserver/web_router.h"
+#include "webserver/web_static_cache.h"
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
 
 #ifndef WEB_DIRECTORY
 #define WEB_DIRECTORY "web"
@@ -69,56 +83,144 @@ static const char *content_type_for_path(const char *path) {
     return "application/octet-stream";
 }
 
-void send_file_response(socket_t client, const char *path) {
-    FILE *file = fopen(path, "rb");
-    if (file == NULL) {
+void send_file_response(HttpClient *client, const char *path) {
+    int fd = open(path, O_RDONLY | O_BINARY);
+    if (fd < 0) {
         send_error(client, "404 Not Found", "Datei nicht gefunden");
         return;
     }
-    if (fseek(file, 0, SEEK_END) != 0) {
-        fclose(file);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
         send_error(client, "500 Internal Server Error", "Dateizugriff fehlgeschlagen");
         return;
     }
-    long size = ftell(file);
-    if (size < 0) {
-        fclose(file);
-        send_error(client, "500 Internal Server Error", "Dateigröße unbekannt");
+    if (!S_ISREG(info.st_mode)) {
+        close(fd);
+        send_error(client, "404 Not Found", "Datei nicht gefunden");
         return;
     }
-    rewind(file);
-    char *data = (char *)malloc((size_t)size);
-    if (data == NULL) {
-        fclose(file);
-        send_error(client, "500 Internal Server Error", "Speicherfehler");
+    const char *content_type = content_type_for_path(path);
+    send_file_with_headers(client, "200 OK", content_type, fd, (uint64_t)info.st_size, NULL);
+}
+
+// Eine gewählte Darstellung einer statischen Datei samt Validatoren
+typedef struct {
+    const char *data;
+    size_t size;
+    const char *etag;
+    const char *last_modified;  // NULL für eingebettete Dateien
+    int gzip;
+    int vary;                   // Es gibt mehrere Darstellungen je nach Accept-Encoding
+} StaticBody;
+
+static void send_static_body(HttpClient *client, const char *content_type, const StaticBody *body,
+                             int not_modified) {
+    char headers[256];
+    int len = snprintf(headers, sizeof headers, "ETag: %s\r\n", body->etag);
+    if (body->last_modified != NULL) {
+        len += snprintf(headers + len, sizeof headers - (size_t)len, "Last-Modified: %s\r\n", body->last_modified);
+    }
+    snprintf(headers + len, sizeof headers - (size_t)len, "Cache-Control: no-cache\r\n%s%s",
+             body->gzip ? "Content-Encoding: gzip\r\n" : "",
+             body->vary ? "Vary: Accept-Encoding\r\n" : "");
+    if (not_modified) {
+        send_response_with_headers(client, "304 Not Modified", content_type, NULL, 0, headers);
+    } else {
+        send_response_with_headers(client, "200 OK", content_type, body->data, body->size, headers);
+    }
+}
+
+static void send_static_asset(HttpClient *client, const HttpRequest *req, const char *path) {
+    const char *content_type = content_type_for_path(path);
+    StaticAsset *asset = NULL;
+    StaticCacheResult result = static_cache_acquire(path, content_type, &asset);
+    if (result == STATIC_CACHE_NOT_FOUND) {
+        send_error(client, "404 Not Found", "Datei nicht gefunden");
         return;
     }
-    size_t read_bytes = fread(data, 1, (size_t)size, file);
-    fclose(file);
-    if (read_bytes != (size_t)size) {
-        free(data);
-        send_error(client, "500 Internal Server Error", "Dateilesefehler");
+    if (result == STATIC_CACHE_BYPASS) {
+        send_file_response(client, path);
         return;
     }
-    const char *content_type = content_type_for_path(path);
-    send_response(client, "200 OK", content_type, data, (size_t)size);
-    free(data);
+    int gzip = req->accepts_gzip && asset->gzip_data != NULL;
+    StaticBody body = {
+        gzip ? asset->gzip_data : asset->data,
+        gzip ? asset->gzip_size : asset->size,
+        gzip ? asset->gzip_etag : asset->etag,
+        asset->last_modified,
+        gzip,
+        asset->gzip_data != NULL
+    };
+    send_static_body(client, content_type, &body,
+                     static_asset_not_modified(asset, gzip, req->if_none_match, req->if_modified_since));
+    static_cache_release(asset);
 }
 
-void handle_static_root(socket_t client) {
+static void send_embedded_asset(HttpClient *client, const HttpRequest *req, const char *relative) {
+    while (*relative == '/') {
+        relative++;
+    }
+    if (*relative == '\0') {
+        relative = "index.html";
+    }
+    const EmbeddedAsset *asset = web_asset_lookup(relative);
+    if (asset == NULL) {
+        send_error(client, "404 Not Found", "Datei nicht gefunden");
+        return;
+    }
+    EmbeddedVariant variant;
+    int has_gzip = web_asset_gzip_variant(asset, &variant);
+    int gzip = req->accepts_gzip && has_gzip;
+    StaticBody body = {
+        (const char *)(gzip ? variant.data : asset->data),
+        gzip ? variant.size : asset->size,
+        gzip ? variant.etag : asset->etag,
+        NULL,
+        gzip,
+        has_gzip
+    };
+    int not_modified = req->if_none_match[0] != '\0' && static_etag_matches(req->if_none_match, body.etag);
+    send_static_body(client, asset->content_type, &body, not_modified);
+}
+
+void handle_static_root(HttpClient *client, const HttpRequest *req) {
+    if (web_assets_embedded()) {
+        send_embedded_asset(client, req, "index.html");
+        return;
+    }
     char path[512];
     if (build_static_path("index.html", path, sizeof path) != 0) {
         send_error(client, "500 Internal Server Error", "Frontend nicht gefunden");
         return;
     }
-    send_file_response(client, path);
+    send_static_asset(client, req, path);
 }
 
-void handle_static_request(socket_t client, const char *relative) {
+void handle_static_request(HttpClient *client, const HttpRequest *req, const char *relative) {
     char path[512];
     if (build_static_path(relative, path, sizeof path) != 0) {
         send_error(client, "400 Bad Request", "Ungültiger Pfad");
         return;
     }
-    send_file_response(client, path);
+    if (web_assets_embedded()) {
+        send_embedded_asset(client, req, relative);
+        return;
+    }
+    send_static_asset(client, req, path);
+}
+
+#define STATIC_ROUTE_PREFIX "/static/"
+
+static void handle_static_prefix(HttpClient *client, const HttpRequest *req) {
+    handle_static_request(client, req, req->path + strlen(STATIC_ROUTE_PREFIX));
+}
+
+static const WebRoute STATIC_ROUTES[] = {
+    { "/",                 ROUTE_GET, 0, handle_static_root },
+    { STATIC_ROUTE_PREFIX, ROUTE_GET, 1, handle_static_prefix },
+};
+
+int web_static_register_routes(void) {
+    return web_router_register(STATIC_ROUTES, sizeof STATIC_ROUTES / sizeof STATIC_ROUTES[0]);
 }
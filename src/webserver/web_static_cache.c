@@ -0,0 +1,245 @@
+#include "webserver/web_static_cache.h"
+
+#include "config.h"
+#include "webserver/web_core.h"
+#include "webserver/web_gzip.h"
+#include "webserver/web_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define STATIC_CACHE_MAX_ENTRIES 64
+
+typedef struct {
+    StaticAsset *entries[STATIC_CACHE_MAX_ENTRIES];
+    size_t count;
+    size_t total_bytes;
+} StaticCache;
+
+static StaticCache g_cache;
+static web_rwlock_t g_cache_lock = WEB_RWLOCK_INIT;
+
+static const char *const WEEKDAYS[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char *const MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+static uint64_t fnv1a_64(const char *data, size_t len) {
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Tage seit 1970-01-01 für ein Datum im gregorianischen Kalender
+static long days_from_civil(long year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yoe = (unsigned)(year - era * 400);
+    unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+static void format_http_date(time_t when, char *out, size_t out_size) {
+    long long seconds = (long long)when;
+    long long days = seconds / 86400;
+    long long rem = seconds % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        days--;
+    }
+    // Umkehrung von days_from_civil
+    long long z = days + 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long year = (long long)yoe + era * 400;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    if (month <= 2) {
+        year++;
+    }
+    int weekday = (int)((days % 7 + 11) % 7);
+    // IMF-fixdate kennt nur vierstellige Jahre; begrenzt auch die Länge der Ausgabe
+    int year4 = year < 0 ? 0 : year > 9999 ? 9999 : (int)year;
+    snprintf(out, out_size, "%s, %02u %s %04d %02d:%02d:%02d GMT",
+             WEEKDAYS[weekday], day, MONTHS[month - 1], year4,
+             (int)(rem / 3600), (int)(rem % 3600 / 60), (int)(rem % 60));
+}
+
+static int parse_http_date(const char *text, time_t *out) {
+    char month_name[4];
+    int day = 0;
+    int year = 0;
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    if (sscanf(text, "%*3s, %d %3s %d %d:%d:%d GMT", &day, month_name, &year, &hour, &minute, &second) != 6) {
+        return -1;
+    }
+    for (unsigned month = 0; month < 12; month++) {
+        if (strcmp(month_name, MONTHS[month]) == 0) {
+            long days = days_from_civil(year, month + 1, (unsigned)day);
+            *out = (time_t)((long long)days * 86400 + hour * 3600 + minute * 60 + second);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void free_asset(StaticAsset *asset) {
+    free(asset->gzip_data);
+    free(asset->data);
+    free(asset);
+}
+
+static size_t asset_bytes(const StaticAsset *asset) {
+    return asset->size + asset->gzip_size;
+}
+
+// Die gzip-Variante wird einmal beim Laden erzeugt und nur behalten, wenn sie kleiner ist
+static void compress_asset(StaticAsset *asset) {
+    if (!web_gzip_worthwhile(asset->content_type)) {
+        return;
+    }
+    unsigned char *packed = NULL;
+    size_t packed_size = 0;
+    if (web_gzip_compress((const unsigned char *)asset->data, asset->size, &packed, &packed_size) != 0) {
+        return;
+    }
+    if (packed_size >= asset->size) {
+        free(packed);
+        return;
+    }
+    asset->gzip_data = (char *)packed;
+    asset->gzip_size = packed_size;
+    snprintf(asset->gzip_etag, sizeof asset->gzip_etag, "\"%.16s-gz\"", asset->etag + 1);
+}
+
+static int find_entry(const char *path) {
+    for (size_t i = 0; i < g_cache.count; i++) {
+        if (strcmp(g_cache.entries[i]->path, path) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static StaticAsset *load_asset(const char *path, const struct stat *info, const char *content_type) {
+    StaticAsset *asset = (StaticAsset *)calloc(1, sizeof *asset);
+    if (asset == NULL) {
+        return NULL;
+    }
+    asset->data = (char *)malloc(info->st_size > 0 ? (size_t)info->st_size : 1);
+    FILE *file = fopen(path, "rb");
+    if (asset->data == NULL || file == NULL) {
+        if (file != NULL) {
+            fclose(file);
+        }
+        free_asset(asset);
+        return NULL;
+    }
+    asset->size = fread(asset->data, 1, (size_t)info->st_size, file);
+    fclose(file);
+    if (asset->size != (size_t)info->st_size) {
+        free_asset(asset);
+        return NULL;
+    }
+    strncpy(asset->path, path, sizeof asset->path - 1);
+    asset->mtime = info->st_mtime;
+    asset->mtime_ns = file_mtime_ns(info);
+    asset->content_type = content_type;
+    snprintf(asset->etag, sizeof asset->etag, "\"%016llx\"",
+             (unsigned long long)fnv1a_64(asset->data, asset->size));
+    format_http_date(asset->mtime, asset->last_modified, sizeof asset->last_modified);
+    compress_asset(asset);
+    return asset;
+}
+
+StaticCacheResult static_cache_acquire(const char *path, const char *content_type, StaticAsset **out) {
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return STATIC_CACHE_NOT_FOUND;
+    }
+    if ((uint64_t)info.st_size > g_config.static_cache_max_file_size ||
+        strlen(path) >= STATIC_CACHE_MAX_PATH) {
+        return STATIC_CACHE_BYPASS;
+    }
+
+    // Treffer brauchen nur die Lesesperre; ersetzt oder verdrängt wird unter der Schreibsperre
+    web_rwlock_read_lock(&g_cache_lock);
+    int index = find_entry(path);
+    if (index >= 0) {
+        StaticAsset *cached = g_cache.entries[index];
+        if (cached->mtime_ns == file_mtime_ns(&info) && cached->size == (size_t)info.st_size) {
+            web_refcount_retain(&cached->refcount);
+            web_rwlock_read_unlock(&g_cache_lock);
+            *out = cached;
+            return STATIC_CACHE_HIT;
+        }
+    }
+    web_rwlock_read_unlock(&g_cache_lock);
+
+    // Datei außerhalb der Sperre lesen, damit andere Anfragen nicht warten
+    StaticAsset *fresh = load_asset(path, &info, content_type);
+    if (fresh == NULL) {
+        return STATIC_CACHE_BYPASS;
+    }
+
+    web_rwlock_write_lock(&g_cache_lock);
+    index = find_entry(path);
+    size_t freed = index >= 0 ? asset_bytes(g_cache.entries[index]) : 0;
+    if ((index < 0 && g_cache.count >= STATIC_CACHE_MAX_ENTRIES) ||
+        g_cache.total_bytes - freed + asset_bytes(fresh) > g_config.static_cache_max_bytes) {
+        web_rwlock_write_unlock(&g_cache_lock);
+        free_asset(fresh);
+        return STATIC_CACHE_BYPASS;
+    }
+    StaticAsset *old = NULL;
+    if (index >= 0) {
+        old = g_cache.entries[index];
+        g_cache.entries[index] = fresh;
+    } else {
+        g_cache.entries[g_cache.count++] = fresh;
+    }
+    g_cache.total_bytes = g_cache.total_bytes - freed + asset_bytes(fresh);
+    web_refcount_set(&fresh->refcount, 2);
+    web_rwlock_write_unlock(&g_cache_lock);
+    // Laufende Antworten behalten die alte Version, bis sie sie freigeben
+    if (old != NULL && web_refcount_drop(&old->refcount)) {
+        free_asset(old);
+    }
+    *out = fresh;
+    return STATIC_CACHE_HIT;
+}
+
+void static_cache_release(StaticAsset *asset) {
+    if (asset != NULL && web_refcount_drop(&asset->refcount)) {
+        free_asset(asset);
+    }
+}
+
+int static_etag_matches(const char *if_none_match, const char *etag) {
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL;
+}
+
+int static_asset_not_modified(const StaticAsset *asset, int gzip, const char *if_none_match,
+                              const char *if_modified_since) {
+    // If-None-Match hat Vorrang vor If-Modified-Since (RFC 7232, Abschnitt 6)
+    if (if_none_match != NULL && *if_none_match != '\0') {
+        return static_etag_matches(if_none_match, gzip ? asset->gzip_etag : asset->etag);
+    }
+    if (if_modified_since != NULL && *if_modified_since != '\0') {
+        time_t since;
+        if (parse_http_date(if_modified_since, &since) == 0) {
+            return asset->mtime <= since;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,308 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "webserver/web_thread.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+typedef struct {
+    web_thread_fn fn;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI thread_trampoline(LPVOID param) {
+#else
+static void *thread_trampoline(void *param) {
+#endif
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+int web_thread_start(web_thread_t *thread, web_thread_fn fn, void *arg) {
+    ThreadStart *start = (ThreadStart *)malloc(sizeof *start);
+    if (start == NULL) {
+        return -1;
+    }
+    start->fn = fn;
+    start->arg = arg;
+#ifdef _WIN32
+    HANDLE handle = CreateThread(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (handle == NULL) {
+        free(start);
+        return -1;
+    }
+    *thread = handle;
+#else
+    if (pthread_create(thread, NULL, thread_trampoline, start) != 0) {
+        free(start);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+void web_thread_join(web_thread_t thread) {
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+void web_mutex_init(web_mutex_t *mutex) {
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void web_mutex_lock(web_mutex_t *mutex) {
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void web_mutex_unlock(web_mutex_t *mutex) {
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void web_cond_init(web_cond_t *cond) {
+#ifdef _WIN32
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+void web_cond_wait(web_cond_t *cond, web_mutex_t *mutex) {
+#ifdef _WIN32
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void web_cond_signal(web_cond_t *cond) {
+#ifdef _WIN32
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
+
+void web_rwlock_read_lock(web_rwlock_t *lock) {
+#ifdef _WIN32
+    AcquireSRWLockShared(lock);
+#else
+    pthread_rwlock_rdlock(lock);
+#endif
+}
+
+void web_rwlock_read_unlock(web_rwlock_t *lock) {
+#ifdef _WIN32
+    ReleaseSRWLockShared(lock);
+#else
+    pthread_rwlock_unlock(lock);
+#endif
+}
+
+void web_rwlock_write_lock(web_rwlock_t *lock) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(lock);
+#else
+    pthread_rwlock_wrlock(lock);
+#endif
+}
+
+void web_rwlock_write_unlock(web_rwlock_t *lock) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(lock);
+#else
+    pthread_rwlock_unlock(lock);
+#endif
+}
+
+void web_refcount_set(web_refcount_t *count, int value) {
+#ifdef _MSC_VER
+    InterlockedExchange(count, (LONG)value);
+#else
+    atomic_store(count, value);
+#endif
+}
+
+void web_refcount_retain(web_refcount_t *count) {
+#ifdef _MSC_VER
+    InterlockedIncrement(count);
+#else
+    atomic_fetch_add(count, 1);
+#endif
+}
+
+int web_refcount_drop(web_refcount_t *count) {
+#ifdef _MSC_VER
+    return InterlockedDecrement(count) == 0;
+#else
+    return atomic_fetch_sub(count, 1) == 1;
+#endif
+}
+
+int web_refcount_get(web_refcount_t *count) {
+#ifdef _MSC_VER
+    return (int)InterlockedCompareExchange(count, 0, 0);
+#else
+    return atomic_load(count);
+#endif
+}
+
+uint64_t web_counter_load(web_counter_t *counter) {
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedCompareExchange64(counter, 0, 0);
+#else
+    return atomic_load(counter);
+#endif
+}
+
+void web_counter_store(web_counter_t *counter, uint64_t value) {
+#ifdef _MSC_VER
+    InterlockedExchange64(counter, (LONG64)value);
+#else
+    atomic_store(counter, value);
+#endif
+}
+
+uint64_t web_counter_next(web_counter_t *counter) {
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedIncrement64(counter);
+#else
+    return atomic_fetch_add(counter, 1) + 1;
+#endif
+}
+
+int web_thread_pin_to_cpu(size_t cpu) {
+#if defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8) {
+        return -1;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0 ? 0 : -1;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof set, &set) == 0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+int web_thread_allowed_cpu(size_t n, size_t *cpu) {
+#if defined(_WIN32)
+    DWORD_PTR process_mask;
+    DWORD_PTR system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || process_mask == 0) {
+        return -1;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < sizeof process_mask * 8; i++) {
+        count += (process_mask >> i) & 1u;
+    }
+    n %= count;
+    for (size_t i = 0; i < sizeof process_mask * 8; i++) {
+        if (((process_mask >> i) & 1u) && n-- == 0) {
+            *cpu = i;
+            return 0;
+        }
+    }
+    return -1;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) != 0 || CPU_COUNT(&set) == 0) {
+        return -1;
+    }
+    n %= (size_t)CPU_COUNT(&set);
+    for (size_t i = 0; i < CPU_SETSIZE; i++) {
+        if (CPU_ISSET(i, &set) && n-- == 0) {
+            *cpu = i;
+            return 0;
+        }
+    }
+    return -1;
+#else
+    (void)n;
+    (void)cpu;
+    return -1;
+#endif
+}
+
+void web_sleep_ms(unsigned milliseconds) {
+#ifdef _WIN32
+    Sleep(milliseconds);
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(milliseconds / 1000u);
+    ts.tv_nsec = (long)(milliseconds % 1000u) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+#endif
+}
+
+size_t web_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) == 0 && CPU_COUNT(&set) > 0) {
+        return (size_t)CPU_COUNT(&set);
+    }
+#endif
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+uint64_t web_monotonic_us(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000u +
+           (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000u / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
@@ -0,0 +1,162 @@
+#include "webserver/web_timer.h"
+
+#define SLOT_MASK (WEB_TIMER_SLOTS - 1u)
+#define LEVEL_SPAN(level) ((uint64_t)1 << (WEB_TIMER_SLOT_BITS * (level)))
+#define MAX_DELTA (LEVEL_SPAN(WEB_TIMER_LEVELS) - 1u)
+
+static void list_init(WebTimer *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static int list_empty(const WebTimer *head) {
+    return head->next == head;
+}
+
+static void list_append(WebTimer *head, WebTimer *timer) {
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void list_unlink(WebTimer *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+// Hängt den Inhalt von from an die leere Liste to um
+static void list_move(WebTimer *from, WebTimer *to) {
+    list_init(to);
+    if (list_empty(from)) {
+        return;
+    }
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    list_init(from);
+}
+
+// Stufe und Fach ergeben sich aus dem Abstand zum aktuellen Tick
+static void insert_timer(WebTimerWheel *wheel, WebTimer *timer) {
+    uint64_t expires = timer->expires;
+    if (expires < wheel->current) {
+        expires = wheel->current;
+    }
+    uint64_t delta = expires - wheel->current;
+    if (delta > MAX_DELTA) {
+        expires = wheel->current + MAX_DELTA;
+        delta = MAX_DELTA;
+    }
+    unsigned level = 0;
+    while (level + 1 < WEB_TIMER_LEVELS && delta >= LEVEL_SPAN(level + 1)) {
+        level++;
+    }
+    unsigned slot = (unsigned)(expires >> (WEB_TIMER_SLOT_BITS * level)) & SLOT_MASK;
+    list_append(&wheel->slots[level][slot], timer);
+}
+
+// Verteilt ein Fach einer höheren Stufe auf die darunterliegenden; liefert dessen Index
+static unsigned cascade(WebTimerWheel *wheel, unsigned level) {
+    unsigned slot = (unsigned)(wheel->current >> (WEB_TIMER_SLOT_BITS * level)) & SLOT_MASK;
+    WebTimer pending;
+    list_move(&wheel->slots[level][slot], &pending);
+    while (!list_empty(&pending)) {
+        WebTimer *timer = pending.next;
+        list_unlink(timer);
+        insert_timer(wheel, timer);
+    }
+    return slot;
+}
+
+void web_timer_wheel_init(WebTimerWheel *wheel, uint64_t now_us, uint64_t tick_us) {
+    for (unsigned level = 0; level < WEB_TIMER_LEVELS; level++) {
+        for (unsigned slot = 0; slot < WEB_TIMER_SLOTS; slot++) {
+            list_init(&wheel->slots[level][slot]);
+        }
+    }
+    wheel->current = 0;
+    wheel->start_us = now_us;
+    wheel->tick_us = tick_us > 0 ? tick_us : 1;
+    wheel->count = 0;
+}
+
+void web_timer_init(WebTimer *timer) {
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->expires = 0;
+}
+
+int web_timer_pending(const WebTimer *timer) {
+    return timer->next != NULL;
+}
+
+void web_timer_schedule(WebTimerWheel *wheel, WebTimer *timer, uint64_t deadline_us) {
+    if (web_timer_pending(timer)) {
+        list_unlink(timer);
+    } else {
+        wheel->count++;
+    }
+    // Aufrunden: ein Timer läuft nie vor seiner Frist ab
+    uint64_t elapsed = deadline_us > wheel->start_us ? deadline_us - wheel->start_us : 0;
+    timer->expires = (elapsed + wheel->tick_us - 1) / wheel->tick_us;
+    insert_timer(wheel, timer);
+}
+
+void web_timer_cancel(WebTimerWheel *wheel, WebTimer *timer) {
+    if (web_timer_pending(timer)) {
+        list_unlink(timer);
+        wheel->count--;
+    }
+}
+
+size_t web_timer_advance(WebTimerWheel *wheel, uint64_t now_us, web_timer_fn fn, void *context) {
+    if (now_us < wheel->start_us) {
+        return 0;
+    }
+    uint64_t target = (now_us - wheel->start_us) / wheel->tick_us;
+    size_t expired = 0;
+    while (wheel->current <= target) {
+        unsigned slot = (unsigned)wheel->current & SLOT_MASK;
+        // Beim Überlauf einer Stufe rücken die Timer der nächsthöheren nach
+        for (unsigned level = 1; slot == 0 && level < WEB_TIMER_LEVELS; level++) {
+            if (cascade(wheel, level) != 0) {
+                break;
+            }
+        }
+        WebTimer due;
+        list_move(&wheel->slots[0][slot], &due);
+        wheel->current++;
+        // Einzeln aushängen, damit Rückrufe andere fällige Timer abbrechen können
+        while (!list_empty(&due)) {
+            WebTimer *timer = due.next;
+            list_unlink(timer);
+            wheel->count--;
+            expired++;
+            fn(timer, context);
+        }
+    }
+    return expired;
+}
+
+int web_timer_next_timeout_ms(const WebTimerWheel *wheel, uint64_t now_us) {
+    if (wheel->count == 0) {
+        return -1;
+    }
+    // Erstes belegtes Fach der untersten Stufe, höchstens bis zum nächsten Überlauf
+    uint64_t tick = wheel->current;
+    do {
+        if (!list_empty(&wheel->slots[0][tick & SLOT_MASK])) {
+            break;
+        }
+        tick++;
+    } while ((tick & SLOT_MASK) != 0);
+    uint64_t due_us = wheel->start_us + tick * wheel->tick_us;
+    if (due_us <= now_us) {
+        return 0;
+    }
+    return (int)((due_us - now_us + 999u) / 1000u);
+}
@@ -0,0 +1,106 @@
+#include "webserver/web_trace.h"
+
+#ifdef WEB_TRACE_ENABLED
+
+#include "config.h"
+#include "webserver/web_log.h"
+#include "webserver/web_thread.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TRACE_MAX_DEPTH 8
+
+// Ein Worker bzw. Reaktor bearbeitet immer nur eine Anfrage zugleich
+typedef struct {
+    int active;
+    uint64_t start_us;
+    uint64_t switched_us;      // Letzter Phasenwechsel; die Zeit seitdem gehört der innersten Phase
+    WebTracePhase stack[TRACE_MAX_DEPTH];
+    int depth;                 // Kann TRACE_MAX_DEPTH überschreiten, dann zählt die tiefste gespeicherte
+    uint64_t phase_us[WEB_TRACE_PHASE_COUNT];
+} TraceSpan;
+
+static WEB_THREAD_LOCAL TraceSpan t_span;
+
+static const char *const PHASE_NAMES[WEB_TRACE_PHASE_COUNT] = {
+    "read", "parse", "resolve_path", "load_database", "load_list", "compare", "serialize", "send", "handler"
+};
+
+static void charge_current(uint64_t now) {
+    int top = t_span.depth < TRACE_MAX_DEPTH ? t_span.depth : TRACE_MAX_DEPTH;
+    t_span.phase_us[t_span.stack[top - 1]] += now - t_span.switched_us;
+    t_span.switched_us = now;
+}
+
+void web_trace_first_byte(void) {
+    memset(&t_span, 0, sizeof t_span);
+    t_span.active = 1;
+    t_span.start_us = web_monotonic_us();
+    t_span.switched_us = t_span.start_us;
+    t_span.stack[0] = WEB_TRACE_READ;
+    t_span.depth = 1;
+}
+
+void web_trace_request_begin(void) {
+    if (!t_span.active) {
+        web_trace_first_byte();
+    }
+    charge_current(web_monotonic_us());
+    t_span.stack[0] = WEB_TRACE_HANDLER;
+    t_span.depth = 1;
+}
+
+void web_trace_enter(WebTracePhase phase) {
+    if (!t_span.active) {
+        return;
+    }
+    charge_current(web_monotonic_us());
+    if (t_span.depth < TRACE_MAX_DEPTH) {
+        t_span.stack[t_span.depth] = phase;
+    }
+    t_span.depth++;
+}
+
+void web_trace_leave(void) {
+    if (!t_span.active || t_span.depth <= 1) {
+        return;
+    }
+    charge_current(web_monotonic_us());
+    t_span.depth--;
+}
+
+void web_trace_request_end(const char *method, const char *path, int status) {
+    if (!t_span.active) {
+        return;
+    }
+    uint64_t now = web_monotonic_us();
+    charge_current(now);
+    t_span.active = 0;
+    uint64_t total_us = now - t_span.start_us;
+    if (g_config.slow_request_ms < 0 || total_us < (uint64_t)g_config.slow_request_ms * 1000u ||
+        g_config.log_level < LOG_LEVEL_WARN) {
+        return;
+    }
+    char line[WEB_LOG_MESSAGE_MAX];
+    int len = snprintf(line, sizeof line, "Langsame Anfrage: %s %.128s -> %d in %llu us (",
+                       method, path, status, (unsigned long long)total_us);
+    const char *separator = "";
+    for (int phase = 0; phase < WEB_TRACE_PHASE_COUNT && len > 0 && (size_t)len < sizeof line; phase++) {
+        if (t_span.phase_us[phase] == 0) {
+            continue;
+        }
+        len += snprintf(line + len, sizeof line - (size_t)len, "%s%s %llu", separator,
+                        PHASE_NAMES[phase], (unsigned long long)t_span.phase_us[phase]);
+        separator = ", ";
+    }
+    web_log_message(LOG_LEVEL_WARN, "%s)", line);
+}
+
+#else
+
+// ISO C verbietet leere Übersetzungseinheiten
+typedef int web_trace_disabled;
+
+#endif
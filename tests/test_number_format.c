@@ -0,0 +1,53 @@
+#include "number_format.h"
+
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+static int g_failures;
+
+static void expect_fixed(double value, int decimals, const char *expected) {
+    char out[NUMBER_FORMAT_MAX];
+    size_t len = format_fixed(value, decimals, out);
+    if (strcmp(out, expected) != 0 || len != strlen(expected)) {
+        fprintf(stderr, "format_fixed(%g, %d): \"%s\" (%zu), erwartet \"%s\"\n",
+                value, decimals, out, len, expected);
+        g_failures++;
+    }
+}
+
+static void expect_bounded(double value, int decimals) {
+    char out[NUMBER_FORMAT_MAX];
+    size_t len = format_fixed(value, decimals, out);
+    if (len >= NUMBER_FORMAT_MAX || len != strlen(out)) {
+        fprintf(stderr, "format_fixed(%g, %d): Länge %zu passt nicht zur Ausgabe\n", value, decimals, len);
+        g_failures++;
+    }
+}
+
+int main(void) {
+    expect_fixed(0.0, 2, "0.00");
+    expect_fixed(1.5, 0, "2");
+    expect_fixed(-2.345, 2, "-2.35");
+    // Exakt darstellbarer Grenzfall: wie printf zur geraden Ziffer
+    expect_fixed(0.125, 2, "0.12");
+    expect_fixed(123456.789, 6, "123456.789000");
+    // Zu lang für NUMBER_FORMAT_MAX: Exponentenschreibweise statt abgeschnittener Ziffern
+    expect_fixed(1e300, 6, "1.0000000000000001e+300");
+    expect_bounded(1e300, 6);
+    expect_bounded(-1.7976931348623157e308, 9);
+    expect_bounded(1e40, 2);
+
+    // Der langsame Weg darf den Dezimaltrenner der Locale nicht übernehmen
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8") != NULL || setlocale(LC_NUMERIC, "de_DE") != NULL) {
+        expect_fixed(1e12, 2, "1000000000000.00");
+        expect_fixed(0.125, 2, "0.12");
+        setlocale(LC_NUMERIC, "C");
+    }
+
+    if (g_failures != 0) {
+        fprintf(stderr, "%d Fehler\n", g_failures);
+        return 1;
+    }
+    return 0;
+}